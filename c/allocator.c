@@ -0,0 +1,267 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "allocator.h"
+
+
+// --------------------------------------------------- typedefs and structs ---
+struct arena_block_t
+{
+    char * data;
+    size_t size;
+};
+
+#define max(a,b)      ( (a)>(b) ? (a) : (b) )
+#define ARENA_ALIGN   16
+#define ARENA_ROUND(n) ( ((n) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN )
+
+
+// -------------------------------------------------------- allocator_alloc ---
+void *
+allocator_alloc( const allocator_t * self, size_t size )
+{
+    void * pointer = self ? self->alloc( self->context, size )
+                          : malloc( size );
+    if( !pointer && size )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    return pointer;
+}
+
+
+// ------------------------------------------------------ allocator_realloc ---
+void *
+allocator_realloc( const allocator_t * self, void * pointer,
+                   size_t old_size, size_t size )
+{
+    pointer = self ? self->realloc( self->context, pointer, old_size, size )
+                   : realloc( pointer, size );
+    if( !pointer && size )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    return pointer;
+}
+
+
+// --------------------------------------------------------- allocator_free ---
+void
+allocator_free( const allocator_t * self, void * pointer, size_t size )
+{
+    if( self )
+    {
+        self->free( self->context, pointer, size );
+    }
+    else
+    {
+        free( pointer );
+    }
+}
+
+
+// ------------------------------------------------------- arena_alloc_hook ---
+void *
+arena_alloc_hook( void * context, size_t size )
+{
+    return arena_alloc( (arena_t *) context, size );
+}
+
+
+// ---------------------------------------------------------- arena_is_last ---
+// Whether some memory is the last one allocated from the current block
+int
+arena_is_last( const arena_t * self, const void * pointer, size_t size )
+{
+    const char * top;
+
+    if( !pointer || (self->current >= self->n_blocks) )
+    {
+        return 0;
+    }
+    top = self->blocks[self->current].data + self->offset;
+    return (const char *) pointer + ARENA_ROUND( max( size, 1 ) ) == top;
+}
+
+
+// ----------------------------------------------------- arena_realloc_hook ---
+void *
+arena_realloc_hook( void * context, void * pointer,
+                    size_t old_size, size_t size )
+{
+    arena_t * self = (arena_t *) context;
+
+    // The last allocation grows in place if the block has room left
+    if( arena_is_last( self, pointer, old_size ) )
+    {
+        struct arena_block_t * block = &self->blocks[self->current];
+        size_t offset = (char *) pointer - block->data;
+        if( offset + size <= block->size )
+        {
+            self->offset = offset + ARENA_ROUND( max( size, 1 ) );
+            return pointer;
+        }
+    }
+    if( size <= old_size )
+    {
+        return pointer;
+    }
+    void * items = arena_alloc( self, size );
+    if( pointer )
+    {
+        memcpy( items, pointer, old_size );
+    }
+    return items;
+}
+
+
+// -------------------------------------------------------- arena_free_hook ---
+void
+arena_free_hook( void * context, void * pointer, size_t size )
+{
+    arena_t * self = (arena_t *) context;
+
+    // Memory freed in reverse allocation order is given back
+    if( arena_is_last( self, pointer, size ) )
+    {
+        self->offset = (char *) pointer - self->blocks[self->current].data;
+    }
+}
+
+
+// -------------------------------------------------------------- arena_new ---
+arena_t *
+arena_new( size_t block_size )
+{
+    assert( block_size );
+
+    arena_t *self = (arena_t *) malloc( sizeof(arena_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->blocks = 0;
+    self->n_blocks = 0;
+    self->block_size = block_size;
+    self->current = 0;
+    self->offset = 0;
+    self->allocator.alloc = arena_alloc_hook;
+    self->allocator.realloc = arena_realloc_hook;
+    self->allocator.free = arena_free_hook;
+    self->allocator.context = self;
+    return self;
+}
+
+
+// ----------------------------------------------------------- arena_delete ---
+void
+arena_delete( arena_t * self )
+{
+    assert( self );
+
+    size_t i;
+    for( i=0; i<self->n_blocks; ++i )
+    {
+        free( self->blocks[i].data );
+    }
+    free( self->blocks );
+    free( self );
+}
+
+
+// ------------------------------------------------------------ arena_reset ---
+void
+arena_reset( arena_t * self )
+{
+    assert( self );
+
+    self->current = 0;
+    self->offset = 0;
+}
+
+
+// ------------------------------------------------------------ arena_alloc ---
+void *
+arena_alloc( arena_t * self, size_t size )
+{
+    assert( self );
+
+    size = ARENA_ROUND( max( size, 1 ) );
+
+    // Following blocks (kept from previous frames) are tried before a new
+    // one is allocated
+    while( (self->current < self->n_blocks) &&
+           (self->offset + size > self->blocks[self->current].size) )
+    {
+        self->current++;
+        self->offset = 0;
+    }
+    if( self->current == self->n_blocks )
+    {
+        struct arena_block_t block;
+        block.size = max( self->block_size, size );
+        block.data = (char *) malloc( block.size );
+        self->blocks = (struct arena_block_t *)
+            realloc( self->blocks, (self->n_blocks+1)*sizeof(block) );
+        if( !block.data || !self->blocks )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n",
+                     __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        self->blocks[self->n_blocks++] = block;
+        self->offset = 0;
+    }
+    self->offset += size;
+    return self->blocks[self->current].data + self->offset - size;
+}
+
+
+// -------------------------------------------------------- arena_allocator ---
+const allocator_t *
+arena_allocator( arena_t * self )
+{
+    assert( self );
+
+    return &self->allocator;
+}
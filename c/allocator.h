@@ -0,0 +1,201 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+#include <stddef.h>
+
+
+/**
+ * @file   allocator.h
+ *
+ * @defgroup allocator Allocators
+ *
+ * Memory allocation interface accepted by vectors (vector_new_with_allocator)
+ * and vertex buffers, either for their storage
+ * (vertex_buffer_new_with_allocator) or for the scratch memory of their
+ * tessellators (vertex_buffer_set_scratch). A null allocator stands for
+ * the system allocator (malloc, realloc and free).
+ *
+ * The frame arena is a bump-pointer allocator: allocations are carved from
+ * large blocks, freeing is a no-op (except for the last allocations, such
+ * that memory freed in reverse order is reused at once) and
+ * the whole arena is reset in O(1) at the end of a frame, blocks being kept
+ * for the next one. Once blocks have grown to the peak need of a frame,
+ * the system allocator is not called anymore.
+ *
+ * Example Usage:
+ * @code
+ * arena_t * arena = arena_new( 1024*1024 );
+ * vertex_buffer_set_scratch( buffer, arena_allocator( arena ) );
+ * // each frame:
+ * vertex_buffer_add_curve4( buffer, ... );
+ * arena_reset( arena );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Allocator interface. Callers give back the size of the memory they
+ * reallocate or free.
+ */
+typedef struct
+{
+    /** Allocates size bytes. */
+    void * (*alloc)( void * context, size_t size );
+
+    /** Reallocates memory of old_size bytes to size bytes. */
+    void * (*realloc)( void * context, void * pointer,
+                       size_t old_size, size_t size );
+
+    /** Frees memory of size bytes. */
+    void (*free)( void * context, void * pointer, size_t size );
+
+    /** User context given to callbacks. */
+    void * context;
+} allocator_t;
+
+
+/**
+ * Frame arena (bump-pointer allocator).
+ */
+typedef struct
+{
+    /** Blocks of memory (pointer and size). */
+    struct arena_block_t * blocks;
+
+    /** Number of blocks. */
+    size_t n_blocks;
+
+    /** Default size of a block. */
+    size_t block_size;
+
+    /** Current block. */
+    size_t current;
+
+    /** Offset of the first free byte of the current block. */
+    size_t offset;
+
+    /** Allocator interface of the arena. */
+    allocator_t allocator;
+} arena_t;
+
+
+/**
+ * Allocates memory, exits on failure.
+ *
+ * @param  self  an allocator (0 for the system one)
+ * @param  size  size in bytes
+ * @return       allocated memory
+ */
+  void *
+  allocator_alloc( const allocator_t * self, size_t size );
+
+
+/**
+ * Reallocates memory, exits on failure.
+ *
+ * @param  self      an allocator (0 for the system one)
+ * @param  pointer   memory to reallocate (or 0)
+ * @param  old_size  current size in bytes
+ * @param  size      new size in bytes
+ * @return           reallocated memory
+ */
+  void *
+  allocator_realloc( const allocator_t * self, void * pointer,
+                     size_t old_size, size_t size );
+
+
+/**
+ * Frees memory.
+ *
+ * @param  self     an allocator (0 for the system one)
+ * @param  pointer  memory to free (or 0)
+ * @param  size     size in bytes
+ */
+  void
+  allocator_free( const allocator_t * self, void * pointer, size_t size );
+
+
+/**
+ * Creates a new frame arena.
+ *
+ * @param  block_size  size of blocks (bigger allocations get their own)
+ * @return             a new frame arena
+ */
+  arena_t *
+  arena_new( size_t block_size );
+
+
+/**
+ * Deletes a frame arena and all its blocks.
+ *
+ * @param  self  a frame arena
+ */
+  void
+  arena_delete( arena_t * self );
+
+
+/**
+ * Releases all allocations at once, in O(1).
+ *
+ * @param  self  a frame arena
+ */
+  void
+  arena_reset( arena_t * self );
+
+
+/**
+ * Allocates memory from an arena (aligned on 16 bytes).
+ *
+ * @param  self  a frame arena
+ * @param  size  size in bytes
+ * @return       allocated memory
+ */
+  void *
+  arena_alloc( arena_t * self, size_t size );
+
+
+/**
+ * Returns the allocator interface of an arena.
+ *
+ * @param  self  a frame arena
+ * @return       an allocator
+ */
+  const allocator_t *
+  arena_allocator( arena_t * self );
+
+/** @} */
+
+#endif /* __ALLOCATOR_H__ */
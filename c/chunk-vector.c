@@ -0,0 +1,225 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "chunk-vector.h"
+
+#define min(a,b) ( (a)<(b) ? (a) : (b) )
+
+
+// ------------------------------------------------------- chunk_vector_new ---
+chunk_vector_t *
+chunk_vector_new( size_t item_size, size_t chunk_size )
+{
+    assert( item_size );
+    assert( chunk_size );
+
+    chunk_vector_t * self;
+
+    self = (chunk_vector_t *) malloc( sizeof(chunk_vector_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->chunks = vector_new( sizeof(void *) );
+    self->chunk_size = chunk_size;
+    self->size = 0;
+    self->item_size = item_size;
+    return self;
+}
+
+
+// ---------------------------------------------------- chunk_vector_delete ---
+void
+chunk_vector_delete( chunk_vector_t * self )
+{
+    assert( self );
+
+    size_t i;
+    for( i=0; i<self->chunks->size; ++i )
+    {
+        free( ((void **) self->chunks->items)[i] );
+    }
+    vector_delete( self->chunks );
+    free( self );
+}
+
+
+// ------------------------------------------------------- chunk_vector_get ---
+void *
+chunk_vector_get( const chunk_vector_t * self, size_t index )
+{
+    assert( self );
+    assert( index < self->size );
+
+    return (char *) chunk_vector_chunk( self, index / self->chunk_size )
+         + (index % self->chunk_size) * self->item_size;
+}
+
+
+// ----------------------------------------------------- chunk_vector_chunk ---
+void *
+chunk_vector_chunk( const chunk_vector_t * self, size_t index )
+{
+    assert( self );
+    assert( index < self->chunks->size );
+
+    return ((void **) self->chunks->items)[index];
+}
+
+
+// ------------------------------------------------------ chunk_vector_size ---
+size_t
+chunk_vector_size( const chunk_vector_t * self )
+{
+    assert( self );
+
+    return self->size;
+}
+
+
+// -------------------------------------------------- chunk_vector_capacity ---
+size_t
+chunk_vector_capacity( const chunk_vector_t * self )
+{
+    assert( self );
+
+    return self->chunks->size * self->chunk_size;
+}
+
+
+// --------------------------------------------------- chunk_vector_reserve ---
+void
+chunk_vector_reserve( chunk_vector_t * self, size_t size )
+{
+    assert( self );
+
+    while( chunk_vector_capacity( self ) < size )
+    {
+        void * chunk = malloc( self->chunk_size * self->item_size );
+        if( !chunk )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n",
+                     __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        vector_push_back( self->chunks, &chunk );
+    }
+}
+
+
+// ---------------------------------------------------- chunk_vector_resize ---
+void
+chunk_vector_resize( chunk_vector_t * self, size_t size )
+{
+    assert( self );
+
+    chunk_vector_reserve( self, size );
+    self->size = size;
+}
+
+
+// ----------------------------------------------------- chunk_vector_clear ---
+void
+chunk_vector_clear( chunk_vector_t * self )
+{
+    assert( self );
+
+    self->size = 0;
+}
+
+
+// ------------------------------------------------- chunk_vector_push_back ---
+void
+chunk_vector_push_back( chunk_vector_t * self, const void * item )
+{
+    chunk_vector_push_back_data( self, item, 1 );
+}
+
+
+// -------------------------------------------- chunk_vector_push_back_data ---
+void
+chunk_vector_push_back_data( chunk_vector_t * self,
+                             const void * data, size_t count )
+{
+    assert( self );
+    assert( data || !count );
+
+    const char * src = (const char *) data;
+
+    chunk_vector_reserve( self, self->size + count );
+    while( count )
+    {
+        size_t offset = self->size % self->chunk_size;
+        size_t n = min( count, self->chunk_size - offset );
+        size_t chunk = self->size / self->chunk_size;
+        char * dst = (char *) chunk_vector_chunk( self, chunk );
+        memcpy( dst + offset * self->item_size, src, n * self->item_size );
+        src += n * self->item_size;
+        self->size += n;
+        count -= n;
+    }
+}
+
+
+// ---------------------------------------- chunk_vector_reserve_contiguous ---
+void *
+chunk_vector_reserve_contiguous( chunk_vector_t * self,
+                                 size_t count, size_t * index )
+{
+    assert( self );
+    assert( index );
+    assert( count <= self->chunk_size );
+
+    size_t first = self->size;
+    size_t offset = first % self->chunk_size;
+
+    if( (offset + count) > self->chunk_size )
+    {
+        first += self->chunk_size - offset;
+    }
+    chunk_vector_reserve( self, first + count );
+    *index = first;
+    if( first == chunk_vector_capacity( self ) )
+    {
+        // Nothing to write at the very end of the allocated chunks
+        return 0;
+    }
+    return (char *) chunk_vector_chunk( self, first / self->chunk_size )
+         + (first % self->chunk_size) * self->item_size;
+}
@@ -0,0 +1,214 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __CHUNK_VECTOR_H__
+#define __CHUNK_VECTOR_H__
+#include <stddef.h>
+
+#include "vector.h"
+
+
+/**
+ * @file   chunk-vector.h
+ *
+ * @defgroup chunk-vector Chunked vector
+ *
+ * Vector whose items are stored into fixed size chunks allocated as
+ * needed. Items never move: pointers to items stay valid while the vector
+ * grows and growing never copies existing items, which matters for very
+ * large vectors (a plain vector needs up to three times its size while
+ * reallocating). Item i is found in chunk i / chunk_size.
+ *
+ * Example Usage:
+ * @code
+ * chunk_vector_t * vector = chunk_vector_new( sizeof(int), 4096 );
+ * int i = 1;
+ * chunk_vector_push_back( vector, &i );
+ * i = * (int *) chunk_vector_get( vector, 0 );
+ * chunk_vector_delete( vector );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Chunked vector.
+ */
+typedef struct
+{
+    /** Pointers to the allocated chunks. */
+    vector_t * chunks;
+
+    /** Number of items per chunk. */
+    size_t chunk_size;
+
+    /** Number of items. */
+    size_t size;
+
+    /** Size (in bytes) of a single item. */
+    size_t item_size;
+} chunk_vector_t;
+
+
+/**
+ * Creates a new empty chunked vector.
+ *
+ * @param  item_size   item size in bytes
+ * @param  chunk_size  number of items per chunk
+ * @return             a new empty chunked vector
+ */
+  chunk_vector_t *
+  chunk_vector_new( size_t item_size, size_t chunk_size );
+
+
+/**
+ * Deletes a chunked vector.
+ *
+ * @param  self  a chunked vector
+ */
+  void
+  chunk_vector_delete( chunk_vector_t * self );
+
+
+/**
+ * Returns a pointer to the item located at specified index.
+ *
+ * @param  self   a chunked vector
+ * @param  index  the index of the item to be returned
+ * @return        pointer on the specified item
+ */
+  void *
+  chunk_vector_get( const chunk_vector_t * self, size_t index );
+
+
+/**
+ * Returns a chunk.
+ *
+ * @param  self   a chunked vector
+ * @param  index  index of the chunk (less than the number of chunks)
+ * @return        pointer on the first item of the chunk
+ */
+  void *
+  chunk_vector_chunk( const chunk_vector_t * self, size_t index );
+
+
+/**
+ * Returns the number of items.
+ *
+ * @param  self  a chunked vector
+ * @return       number of items
+ */
+  size_t
+  chunk_vector_size( const chunk_vector_t * self );
+
+
+/**
+ * Returns the number of items that can be held in allocated chunks.
+ *
+ * @param  self  a chunked vector
+ * @return       capacity
+ */
+  size_t
+  chunk_vector_capacity( const chunk_vector_t * self );
+
+
+/**
+ * Allocates chunks such that the vector can hold at least size items.
+ *
+ * @param  self  a chunked vector
+ * @param  size  number of items
+ */
+  void
+  chunk_vector_reserve( chunk_vector_t * self, size_t size );
+
+
+/**
+ * Resizes the vector, new items being left uninitialized.
+ *
+ * @param  self  a chunked vector
+ * @param  size  new number of items
+ */
+  void
+  chunk_vector_resize( chunk_vector_t * self, size_t size );
+
+
+/**
+ * Removes all items, chunks being kept for later use.
+ *
+ * @param  self  a chunked vector
+ */
+  void
+  chunk_vector_clear( chunk_vector_t * self );
+
+
+/**
+ * Appends an item.
+ *
+ * @param  self  a chunked vector
+ * @param  item  item to be appended
+ */
+  void
+  chunk_vector_push_back( chunk_vector_t * self, const void * item );
+
+
+/**
+ * Appends several items, possibly spanning several chunks.
+ *
+ * @param  self   a chunked vector
+ * @param  data   items to be appended
+ * @param  count  number of items
+ */
+  void
+  chunk_vector_push_back_data( chunk_vector_t * self,
+                               const void * data, size_t count );
+
+
+/**
+ * Finds room for count contiguous items at the end of the vector: at the
+ * end of the last chunk if they fit, at the start of a new chunk
+ * otherwise. The vector is not resized, items are written at the returned
+ * address and committed with chunk_vector_resize( self, *index + count ),
+ * items skipped at the end of the last chunk being left uninitialized.
+ *
+ * @param  self   a chunked vector
+ * @param  count  number of items (at most chunk_size)
+ * @param  index  index of the first item (output)
+ * @return        pointer on the first item
+ */
+  void *
+  chunk_vector_reserve_contiguous( chunk_vector_t * self,
+                                   size_t count, size_t * index );
+
+/** @} */
+
+#endif /* __CHUNK_VECTOR_H__ */
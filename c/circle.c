@@ -42,12 +42,23 @@ vertex_buffer_add_circle( vertex_buffer_t * self,
     typedef struct { vec3 vertex; vec4 color; vec3 tex_coord; } vertex_t;
 
     assert( self );
-    assert( strcmp( vertex_buffer_format( self ), "v3f:c4f:t3f" ) == 0 );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
     vertex_t vertices[4] = {
         { center, color, {{+size.x, +size.y, size.z}} },
         { center, color, {{-size.x, +size.y, size.z}} },
         { center, color, {{-size.x, -size.y, size.z}} },
         { center, color, {{+size.x, -size.y, size.z}} } };
     GLuint indices[6] = { 0,1,2, 0,2,3 };
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        GLuint strip[5] = { 1,0,2,3, VERTEX_BUFFER_RESTART_INDEX };
+        vertex_buffer_append( self, vertices, 4, strip, 5 );
+        return;
+    }
+    if( self->primitive == GL_QUADS )
+    {
+        vertex_buffer_append( self, vertices, 4, 0, 0 );
+        return;
+    }
     vertex_buffer_append( self, vertices, 4, indices,  6 );
 }
@@ -0,0 +1,293 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+#include "clip.h"
+
+
+// ------------------------------------------------------------ clipper_new ---
+clipper_t *
+clipper_new( void )
+{
+    clipper_t *self = (clipper_t *) malloc( sizeof(clipper_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->viewport = (vec4) {{ -FLT_MAX/4, -FLT_MAX/4, FLT_MAX/2, FLT_MAX/2 }};
+    self->points = vector_new( sizeof(vec2) );
+    self->runs   = vector_new( sizeof(size_t) );
+    self->closed = 0;
+    return self;
+}
+
+
+// --------------------------------------------------------- clipper_delete ---
+void
+clipper_delete( clipper_t * self )
+{
+    assert( self );
+
+    vector_delete( self->points );
+    vector_delete( self->runs );
+    free( self );
+}
+
+
+// --------------------------------------------------- clipper_set_viewport ---
+void
+clipper_set_viewport( clipper_t * self,
+                      const matrix_t * transform )
+{
+    assert( self );
+    assert( transform );
+
+    // Vertices are column vectors: ndc = M (x, y, 0, 1)
+    const float * M = transform->data;
+    double a = M[0*4+0], b = M[1*4+0], c = M[0*4+1], d = M[1*4+1];
+    double det = a*d - b*c;
+
+    if( (M[0*4+3] != 0) || (M[1*4+3] != 0) || (M[3*4+3] == 0) || (det == 0) )
+    {
+        self->viewport = (vec4) {{ -FLT_MAX/4, -FLT_MAX/4,
+                                    FLT_MAX/2, FLT_MAX/2 }};
+        return;
+    }
+
+    // Bounding box of the inverse image of the four corners of the square
+    double w = M[3*4+3];
+    double tx = M[3*4+0]/w, ty = M[3*4+1]/w;
+    double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+    size_t i;
+    a /= w; b /= w; c /= w; d /= w; det /= w*w;
+    for( i=0; i<4; ++i )
+    {
+        double u = ((i & 1) ? 1 : -1) - tx;
+        double v = ((i & 2) ? 1 : -1) - ty;
+        double x = ( d*u - b*v) / det;
+        double y = (-c*u + a*v) / det;
+        if( x < xmin ) xmin = x;
+        if( x > xmax ) xmax = x;
+        if( y < ymin ) ymin = y;
+        if( y > ymax ) ymax = y;
+    }
+    self->viewport = (vec4) {{ xmin, ymin, xmax-xmin, ymax-ymin }};
+}
+
+
+// -------------------------------------------------------- clip_parameters ---
+// Liang–Barsky: parameters t0 <= t1 of the part of segment (p0,p1) inside
+// the rectangle [xmin,xmax]x[ymin,ymax].
+int
+clip_parameters( double xmin, double ymin, double xmax, double ymax,
+                 vec2 p0, vec2 p1, double * t0, double * t1 )
+{
+    double dx = p1.x - p0.x;
+    double dy = p1.y - p0.y;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { p0.x - xmin, xmax - p0.x, p0.y - ymin, ymax - p0.y };
+    size_t i;
+
+    *t0 = 0.0;
+    *t1 = 1.0;
+    for( i=0; i<4; ++i )
+    {
+        if( p[i] == 0 )
+        {
+            if( q[i] < 0 )
+            {
+                return 0;
+            }
+            continue;
+        }
+        double r = q[i] / p[i];
+        if( p[i] < 0 )
+        {
+            if( r > *t1 ) return 0;
+            if( r > *t0 ) *t0 = r;
+        }
+        else
+        {
+            if( r < *t0 ) return 0;
+            if( r < *t1 ) *t1 = r;
+        }
+    }
+    return 1;
+}
+
+
+// ----------------------------------------------------------- clip_segment ---
+int
+clip_segment( vec4 rect, float padding, vec2 * p0, vec2 * p1 )
+{
+    assert( p0 );
+    assert( p1 );
+
+    double t0, t1;
+    vec2 a = *p0, b = *p1;
+
+    if( !clip_parameters( rect.x - padding, rect.y - padding,
+                          rect.x + rect.z + padding, rect.y + rect.w + padding,
+                          a, b, &t0, &t1 ) )
+    {
+        return 0;
+    }
+    if( t0 > 0 )
+    {
+        p0->x = a.x + t0*(b.x - a.x);
+        p0->y = a.y + t0*(b.y - a.y);
+    }
+    if( t1 < 1 )
+    {
+        p1->x = a.x + t1*(b.x - a.x);
+        p1->y = a.y + t1*(b.y - a.y);
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------------- clipper_end_run ---
+void
+clipper_end_run( clipper_t * self, size_t start )
+{
+    size_t count = self->points->size - start;
+    vector_push_back( self->runs, &count );
+}
+
+
+// ------------------------------------------------------- clipper_polyline ---
+size_t
+clipper_polyline( clipper_t * self,
+                  const vec2 * points, size_t n_points,
+                  int closed, float padding )
+{
+    assert( self );
+    assert( points || !n_points );
+
+    vec4 r = self->viewport;
+    double xmin = r.x - padding, xmax = r.x + r.z + padding;
+    double ymin = r.y - padding, ymax = r.y + r.w + padding;
+    size_t i, n_segments = closed ? n_points : n_points-1;
+    size_t start = 0;
+    int open = 0, cut = 0, head = 0;
+    double t0, t1;
+
+    vector_clear( self->points );
+    vector_clear( self->runs );
+    self->closed = 0;
+    if( n_points < 2 )
+    {
+        return 0;
+    }
+
+    // Runs of consecutive visible segments, a run ending where a segment
+    // leaves the rectangle (or is rejected)
+    for( i=0; i<n_segments; ++i )
+    {
+        vec2 A = points[i];
+        vec2 B = points[(i+1) % n_points];
+        if( !clip_parameters( xmin, ymin, xmax, ymax, A, B, &t0, &t1 ) ||
+            ((t1 <= t0) && ((A.x != B.x) || (A.y != B.y))) )
+        {
+            if( open )
+            {
+                clipper_end_run( self, start );
+                open = 0;
+            }
+            cut = 1;
+            continue;
+        }
+        if( !open || (t0 > 0) )
+        {
+            if( open )
+            {
+                clipper_end_run( self, start );
+            }
+            vec2 P = {{ A.x + t0*(B.x - A.x), A.y + t0*(B.y - A.y) }};
+            start = self->points->size;
+            vector_push_back( self->points, &P );
+            open = 1;
+            cut |= (t0 > 0);
+
+            // The first run starts at the first point only if the first
+            // segment opened it: a boundary first point whose segment
+            // leaves the rectangle is rejected (t0 == t1 == 0)
+            head |= (i == 0) && (t0 == 0);
+        }
+        if( t1 < 1 )
+        {
+            vec2 P = {{ A.x + t1*(B.x - A.x), A.y + t1*(B.y - A.y) }};
+            vector_push_back( self->points, &P );
+            clipper_end_run( self, start );
+            open = 0;
+            cut = 1;
+        }
+        else
+        {
+            vector_push_back( self->points, &B );
+        }
+    }
+    if( open )
+    {
+        clipper_end_run( self, start );
+    }
+
+    if( closed && !cut )
+    {
+        // Fully inside: the closing point is implicit
+        self->points->size--;
+        size_t count = self->points->size;
+        vector_clear( self->runs );
+        vector_push_back( self->runs, &count );
+        self->closed = 1;
+    }
+    else if( closed && open && head && (self->runs->size > 1) )
+    {
+        // The first and last runs meet at the first point: the first run
+        // goes at the end of the last one
+        size_t first = *(size_t *) vector_get( self->runs, 0 );
+        size_t last = *(size_t *) vector_back( self->runs );
+        vector_reserve( self->points, self->points->size + first );
+        vector_push_back_data( self->points,
+                               vector_get( self->points, 1 ), first-1 );
+        vector_erase_range( self->points, 0, first );
+        vector_erase( self->runs, 0 );
+        *(size_t *) vector_back( self->runs ) = last + first - 1;
+    }
+    return self->runs->size;
+}
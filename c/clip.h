@@ -0,0 +1,157 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __CLIP_H__
+#define __CLIP_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+#include "matrix.h"
+
+
+/**
+ * @file   clip.h
+ *
+ * @defgroup clip Clip
+ *
+ * Clipping of segments and polylines against a viewport rectangle, before
+ * any join or cap geometry is generated (Liang–Barsky). A polyline is split
+ * into the runs of consecutive segments that intersect the rectangle, each
+ * run being tessellated on its own. The rectangle is padded by the extent
+ * of the joins and caps (plus the anti-aliased fringe) such that new run
+ * ends and dropped joins are never visible.
+ *
+ * The viewport rectangle is obtained by mapping the normalized device
+ * coordinates square back through the (affine) transform used to render
+ * the vertices, such that zooming into a large polyline only tessellates
+ * its visible part.
+ *
+ * Example Usage:
+ * @code
+ * clipper_t * clipper = clipper_new( );
+ * clipper_set_viewport( clipper, &projection );
+ * vertex_buffer_add_polyline_clipped( buffer, clipper, points, n, ... );
+ * clipper_delete( clipper );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Polyline clipper (viewport and temporary storage).
+ */
+typedef struct
+{
+    /** Viewport rectangle (x, y, width, height). */
+    vec4 viewport;
+
+    /** Points of the runs of the last clipped polyline (vec2). */
+    vector_t * points;
+
+    /** Number of points of each run of the last clipped polyline. */
+    vector_t * runs;
+
+    /** Whether the last clipped polyline was closed and left uncut. */
+    int closed;
+} clipper_t;
+
+
+/**
+ * Creates a new clipper whose viewport is infinite.
+ *
+ * @return  a new clipper
+ */
+  clipper_t *
+  clipper_new( void );
+
+
+/**
+ * Deletes a clipper.
+ *
+ * @param  self  a clipper
+ */
+  void
+  clipper_delete( clipper_t * self );
+
+
+/**
+ * Sets the viewport of a clipper from a transform (projection, or
+ * projection times modelview). The viewport is the rectangle whose image is
+ * the [-1,1]x[-1,1] square of normalized device coordinates. It is left
+ * infinite if the transform is not affine in x and y.
+ *
+ * @param  self       a clipper
+ * @param  transform  transform applied to the vertices
+ */
+  void
+  clipper_set_viewport( clipper_t * self,
+                        const matrix_t * transform );
+
+
+/**
+ * Clips a segment against a rectangle (Liang–Barsky).
+ *
+ * @param  rect     rectangle (x, y, width, height)
+ * @param  padding  distance the rectangle is grown by on every side
+ * @param  p0       first point of the segment, moved onto the rectangle
+ *                  if outside of it (in/out)
+ * @param  p1       second point of the segment, moved onto the rectangle
+ *                  if outside of it (in/out)
+ * @return          0 if the segment is fully outside, 1 otherwise
+ */
+  int
+  clip_segment( vec4 rect, float padding, vec2 * p0, vec2 * p1 );
+
+
+/**
+ * Clips a polyline against the padded viewport of a clipper.
+ *
+ * Runs are stored into self->points and their sizes into self->runs.
+ * self->closed tells whether the polyline was closed and fully inside.
+ *
+ * @param  self      a clipper
+ * @param  points    polyline points
+ * @param  n_points  number of points
+ * @param  closed    whether the last point connects to the first one
+ * @param  padding   distance the viewport is grown by on every side
+ * @return           number of runs
+ */
+  size_t
+  clipper_polyline( clipper_t * self,
+                    const vec2 * points, size_t n_points,
+                    int closed, float padding );
+
+/** @} */
+
+#endif /* __CLIP_H__ */
@@ -54,6 +54,9 @@ double m_angle_tolerance = 15*M_PI/180.0;
 double m_approximation_scale = 1.0;
 double pi = M_PI;
 
+typedef struct { vec3 vertex; vec4 color; vec3 tex_coord; } curve_vertex_t;
+TYPED_VECTOR( curve_vertex_vector, curve_vertex_t )
+
 
 // ------------------------------------------------------- calc_sq_distance ---
 double
@@ -71,7 +74,7 @@ void
 curve_add_point( vector_t * points, double x, double y )
 {
     vec2 p = {{x,y}};
-    vector_push_back( points, &p );
+    vec2_vector_push_back( points, p );
 }
 
 
@@ -383,19 +386,52 @@ void curve4_recursive_bezier( vector_t *points,
 }
 
 
+// --------------------------------------------------------- curve3_flatten ---
+void
+curve3_flatten( vector_t * points,
+                double x1, double y1,
+                double x2, double y2,
+                double x3, double y3 )
+{
+    assert( points );
+    assert( points->item_size == sizeof(vec2) );
+
+    m_distance_tolerance_square = 0.5 / m_approximation_scale;
+    m_distance_tolerance_square *= m_distance_tolerance_square;
+
+    curve3_recursive_bezier( points, x1, y1, x2, y2, x3, y3, 0 );
+    curve_add_point( points, x3, y3);
+}
+
+
+// --------------------------------------------------------- curve4_flatten ---
+void
+curve4_flatten( vector_t * points,
+                double x1, double y1,
+                double x2, double y2,
+                double x3, double y3,
+                double x4, double y4 )
+{
+    assert( points );
+    assert( points->item_size == sizeof(vec2) );
+
+    m_distance_tolerance_square = 0.5 / m_approximation_scale;
+    m_distance_tolerance_square *= m_distance_tolerance_square;
+
+    curve4_recursive_bezier( points, x1, y1, x2, y2, x3, y3, x4, y4, 0 );
+    curve_add_point( points, x4, y4);
+}
+
+
 // ---------------------------------------------------------- curve3_bezier ---
 vector_t *
 curve3_bezier( double x1, double y1, 
                double x2, double y2, 
                double x3, double y3 )
 {
-    m_distance_tolerance_square = 0.5 / m_approximation_scale;
-    m_distance_tolerance_square *= m_distance_tolerance_square;
-
     vector_t * points = vector_new( sizeof(vec2) );
     curve_add_point( points, x1, y1);
-    curve3_recursive_bezier( points, x1, y1, x2, y2, x3, y3, 0 );
-    curve_add_point( points, x3, y3);
+    curve3_flatten( points, x1, y1, x2, y2, x3, y3 );
 
     return points;
 }
@@ -408,13 +444,9 @@ curve4_bezier( double x1, double y1,
                double x3, double y3,
                double x4, double y4 )
 {
-    m_distance_tolerance_square = 0.5 / m_approximation_scale;
-    m_distance_tolerance_square *= m_distance_tolerance_square;
-
     vector_t * points = vector_new( sizeof(vec2) );
     curve_add_point( points, x1, y1);
-    curve4_recursive_bezier(points, x1, y1, x2, y2, x3, y3, x4, y4, 0);
-    curve_add_point( points, x4, y4);
+    curve4_flatten( points, x1, y1, x2, y2, x3, y3, x4, y4 );
 
     return points;
 }
@@ -430,11 +462,21 @@ vertex_buffer_add_curve3( vertex_buffer_t * self,
                           vec4 color, double thickness )
 {
     assert( self );
-    assert( strcmp( vertex_buffer_format( self ), "v3f:c4f:t3f" ) == 0 );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
 
 }
 
 
+// ----------------------------------------------------------- curve_vertex ---
+curve_vertex_t
+curve_vertex( double x, double y, double s, double t,
+              vec4 color, double thickness )
+{
+    curve_vertex_t vertex = { {{x, y, 0.0}}, color, {{s, t, thickness}} };
+    return vertex;
+}
+
+
 // -------------------------------------------------- vertex_buffer_add_curve4 ---
 void
 vertex_buffer_add_curve4( vertex_buffer_t * self,
@@ -445,23 +487,28 @@ vertex_buffer_add_curve4( vertex_buffer_t * self,
                           vec4 color, double thickness )
 {
     assert( self );
-    assert( strcmp( vertex_buffer_format( self ), "v3f:c4f:t3f" ) == 0 );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
 
-    typedef struct {
-        vec3 vertex;      
-        vec4 color;
-        vec3 tex_coord;
-    } vertex_t;
-
-
-    vector_t *points = curve4_bezier( x1, y1, x2, y2, x3, y3, x4, y4 );
+    vector_t *points = vector_new_with_allocator( sizeof(vec2),
+                                                  self->scratch );
+    curve_add_point( points, x1, y1 );
+    curve4_flatten( points, x1, y1, x2, y2, x3, y3, x4, y4 );
     size_t n = vector_size(points);
 
     int n_vertices = 2*n+2+2;
-    vertex_t * vertices = (vertex_t *) calloc( n_vertices, sizeof(vertex_t) );
+    vector_t * vertices = vector_new_with_allocator( sizeof(curve_vertex_t),
+                                                     self->scratch );
+    vector_reserve( vertices, n_vertices );
 
     int n_indices  = 6*(n+1);
-    GLuint * indices = (GLuint *) calloc( n_indices, sizeof(GLuint) );
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        // A single strip over all the vertices, plus a restart index
+        n_indices = n_vertices+1;
+    }
+    GLuint * indices = (GLuint *)
+        allocator_alloc( self->scratch, n_indices*sizeof(GLuint) );
+    memset( indices, 0, n_indices*sizeof(GLuint) );
 
     float d,w;
     if (thickness < 1.0)
@@ -476,15 +523,14 @@ vertex_buffer_add_curve4( vertex_buffer_t * self,
         w = thickness+2.0;
     }
 
-    vertex_t vertex = { {{0.0, 0.0, 0.0}}, color, {{0.0, 0.0, thickness}} };
+    const vec2 * P = vec2_vector_data( points );
     double x_, y_, x, y;
 
-    int i=0, index=0;
+    int i=0;
     for(i=0; i<n; ++i)
     {
-        vec2 *p = (vec2 *)vector_get( points, i );
-        x = p->x;
-        y = p->y;
+        x = P[i].x;
+        y = P[i].y;
 
         // Extract tangent/ortho vector
         vec2 tangent = {{x-x_, y-y_}};
@@ -499,83 +545,72 @@ vertex_buffer_add_curve4( vertex_buffer_t * self,
         if (i==1)
         {
             // Cap
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x_ + (-ortho.x-tangent.x)*w/2;
-            vertices[index].vertex.y = y_ + (-ortho.y-tangent.y)*w/2;
-            vertices[index].tex_coord.x = -d;
-            vertices[index].tex_coord.y = -d;
-            index++;
-
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x_ + (ortho.x-tangent.x)*w/2;
-            vertices[index].vertex.y = y_ + (ortho.y-tangent.y)*w/2;
-            vertices[index].tex_coord.x = -d;
-            vertices[index].tex_coord.y = +d;
-            index++;
-
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x_ - ortho.x*w/2;
-            vertices[index].vertex.y = y_ - ortho.y*w/2;
-            vertices[index].tex_coord.x = 0;
-            vertices[index].tex_coord.y = -d;
-            index++;
-
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x_ + ortho.x*w/2;
-            vertices[index].vertex.y = y_ + ortho.y*w/2;
-            vertices[index].tex_coord.x = 0;
-            vertices[index].tex_coord.y = +d;
-            index++;
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x_ + (-ortho.x-tangent.x)*w/2, y_ + (-ortho.y-tangent.y)*w/2,
+                -d, -d, color, thickness ) );
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x_ + (ortho.x-tangent.x)*w/2, y_ + (ortho.y-tangent.y)*w/2,
+                -d, +d, color, thickness ) );
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x_ - ortho.x*w/2, y_ - ortho.y*w/2,
+                0, -d, color, thickness ) );
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x_ + ortho.x*w/2, y_ + ortho.y*w/2,
+                0, +d, color, thickness ) );
         }
         if( i > 0 )
         {
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x - ortho.x*w/2;
-            vertices[index].vertex.y = y - ortho.y*w/2;
-            vertices[index].tex_coord.x = i/(float)n;
-            vertices[index].tex_coord.y = -d;
-            index++;
-
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x + ortho.x*w/2;
-            vertices[index].vertex.y = y + ortho.y*w/2;
-            vertices[index].tex_coord.x = i/(float)n;
-            vertices[index].tex_coord.y = +d;
-            index++;
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x - ortho.x*w/2, y - ortho.y*w/2,
+                i/(float)n, -d, color, thickness ) );
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x + ortho.x*w/2, y + ortho.y*w/2,
+                i/(float)n, +d, color, thickness ) );
         }
 
         // Cap
         if( i == (n-1) )
         {
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x + (-ortho.x+tangent.x)*w/2;
-            vertices[index].vertex.y = y + (-ortho.y+tangent.y)*w/2;
-            vertices[index].tex_coord.x = 1+d;
-            vertices[index].tex_coord.y = -d;
-            index++;
-
-            memcpy(&vertices[index], &vertex, sizeof(vertex_t));
-            vertices[index].vertex.x = x + (ortho.x+tangent.x)*w/2;
-            vertices[index].vertex.y = y + (ortho.y+tangent.y)*w/2;
-            vertices[index].tex_coord.x = 1+d;
-            vertices[index].tex_coord.y = +d;
-            index++;
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x + (-ortho.x+tangent.x)*w/2, y + (-ortho.y+tangent.y)*w/2,
+                1+d, -d, color, thickness ) );
+            curve_vertex_vector_push_back( vertices, curve_vertex(
+                x + (ortho.x+tangent.x)*w/2, y + (ortho.y+tangent.y)*w/2,
+                1+d, +d, color, thickness ) );
         }
         x_ = x;
         y_ = y;
     }
-    vector_delete( points );
+    if( vertices->size < n_vertices )
+    {
+        size_t count = n_vertices - vertices->size;
+        memset( curve_vertex_vector_extend( vertices, count ), 0,
+                count*sizeof(curve_vertex_t) );
+    }
 
-    for(i=0; i<=n; ++i)
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        for(i=0; i<n_vertices; ++i)
+        {
+            indices[i] = i;
+        }
+        indices[n_vertices] = VERTEX_BUFFER_RESTART_INDEX;
+    }
+    else
     {
-        indices[6*i+0] = 2*i+0;
-        indices[6*i+1] = 2*i+1;
-        indices[6*i+2] = 2*i+2;
-        indices[6*i+3] = 2*i+1;
-        indices[6*i+4] = 2*i+2;
-        indices[6*i+5] = 2*i+3;
+        for(i=0; i<=n; ++i)
+        {
+            indices[6*i+0] = 2*i+0;
+            indices[6*i+1] = 2*i+1;
+            indices[6*i+2] = 2*i+2;
+            indices[6*i+3] = 2*i+1;
+            indices[6*i+4] = 2*i+2;
+            indices[6*i+5] = 2*i+3;
+        }
     }
-    vertex_buffer_append( self, vertices, n_vertices, indices, n_indices );
-    free( indices );
-    free( vertices );
+    vertex_buffer_append( self, vertices->items, n_vertices,
+                          indices, n_indices );
+    allocator_free( self->scratch, indices, n_indices*sizeof(GLuint) );
+    vector_delete( vertices );
+    vector_delete( points );
 }
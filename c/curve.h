@@ -108,4 +108,39 @@ curve4_bezier( double x1, double y1,
                double x4, double y4 );
 
 
+/**
+ *  Append the points of the given bezier curve to a vector of vec2, the
+ *  first control point excepted (it is assumed to be the last point of the
+ *  vector). Nothing is allocated if the vector is large enough.
+ *
+ *  @param  points  A vector of vec2
+ *  @param  x1,y1   Control point 1
+ *  @param  x2,y2   Control point 2
+ *  @param  x3,y3   Control point 3
+ */
+void
+curve3_flatten( vector_t * points,
+                double x1, double y1,
+                double x2, double y2,
+                double x3, double y3 );
+
+/**
+ *  Append the points of the given bezier curve to a vector of vec2, the
+ *  first control point excepted (it is assumed to be the last point of the
+ *  vector). Nothing is allocated if the vector is large enough.
+ *
+ *  @param  points  A vector of vec2
+ *  @param  x1,y1   Control point 1
+ *  @param  x2,y2   Control point 2
+ *  @param  x3,y3   Control point 3
+ *  @param  x4,y4   Control point 4
+ */
+void
+curve4_flatten( vector_t * points,
+                double x1, double y1,
+                double x2, double y2,
+                double x3, double y3,
+                double x4, double y4 );
+
+
 #endif /* __CURVES_H__ */
@@ -0,0 +1,172 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include "gl-agg.h"
+
+
+
+// ------------------------------------------------------- global variables ---
+vertex_buffer_t *buffer;
+GLuint program;
+matrix_t projection;
+matrix_t modelview;
+path_t *heart, *ring;
+path_style_t style;
+
+
+// ------------------------------------------------------------------ build ---
+void build( void )
+{
+    path_style_t other = style;
+    other.fill_color = (vec4) {{ 0.2, 0.7, 0.2, 0.6 }};
+    other.stroke_color = (vec4) {{ 0.0, 0.0, 0.7, 1.0 }};
+
+    // Each heart is a copy of the geometry compiled once per style change
+    vertex_buffer_clear( buffer );
+    size_t i;
+    for( i=0; i<64; ++i )
+    {
+        vec2 offset = {{ 40 + (i%8)*45, 40 + (i/8)*45 }};
+        vertex_buffer_add_path( buffer, heart, (i%2) ? &style : &other,
+                                offset );
+    }
+    vertex_buffer_add_path( buffer, ring, &style, (vec2) {{ 440, 440 }} );
+    vertex_buffer_add_path( buffer, ring, &other, (vec2) {{ 440, 320 }} );
+}
+
+
+// --------------------------------------------------------------- reshape ---
+void reshape(int width, int height)
+{
+    glViewport( 0, 0, width, height );
+
+    matrix_load_identity( &projection );
+    matrix_ortho( &projection, 0, width, 0, height, -1000, +1000 );
+    matrix_load_identity( &modelview );
+
+    glMatrixMode( GL_PROJECTION );
+    glLoadMatrixf( projection.data );
+
+    glMatrixMode( GL_MODELVIEW );
+    glLoadMatrixf( modelview.data );
+
+    glutPostRedisplay( );
+}
+
+// --------------------------------------------------------------- keyboard ---
+void keyboard( unsigned char key, int x, int y )
+{
+    if ( key == 27 )
+    {
+        exit( EXIT_SUCCESS );
+    }
+    // Style changes only redo the work that depends on them
+    else if ( key == ' ' )
+    {
+        style.thickness = (style.thickness < 4.0) ? style.thickness+0.5 : 0.5;
+        build( );
+        glutPostRedisplay( );
+    }
+    else if ( key == 'c' )
+    {
+        style.fill_color.g = 1.0 - style.fill_color.g;
+        build( );
+        glutPostRedisplay( );
+    }
+}
+
+
+// ---------------------------------------------------------------- display ---
+void
+display( void )
+{
+    glClearColor( 1.0, 1.0, 1.0, 1.0 );
+    glClear( GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT );
+    glEnable( GL_BLEND );
+    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram( program );
+    vertex_buffer_render( buffer, GL_TRIANGLES, "vtc" );
+    glUseProgram( 0 );
+    glutSwapBuffers();
+}
+
+
+
+// ------------------------------------------------------------------- main ---
+int
+main( int argc, char **argv )
+{
+    glutInit( &argc, argv );
+    glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+    glutInitWindowSize( 512, 512) ;
+    glutCreateWindow( argv[0] );
+    glutDisplayFunc( display );
+    glutReshapeFunc( reshape );
+    glutKeyboardFunc( keyboard );
+
+    buffer = vertex_buffer_new( "v3f:c4f:t3f" ); 
+    program = shader_load( "shaders/line-aa.vert",
+                           "shaders/line-aa-round.frag" );
+
+    // Heart made of two cubic curves
+    heart = path_new( );
+    path_move_to( heart, 0, -20 );
+    path_cubic_to( heart, -30, 0, -25, 25, 0, 12 );
+    path_cubic_to( heart, 25, 25, 30, 0, 0, -20 );
+    path_close( heart );
+
+    // Rounded ring made of quadratic curves with a square hole
+    ring = path_new( );
+    path_move_to( ring, 40, 0 );
+    path_quad_to( ring, 40, 40, 0, 40 );
+    path_quad_to( ring, -40, 40, -40, 0 );
+    path_quad_to( ring, -40, -40, 0, -40 );
+    path_quad_to( ring, 40, -40, 40, 0 );
+    path_close( ring );
+    path_move_to( ring, 15, 15 );
+    path_line_to( ring, -15, 15 );
+    path_line_to( ring, -15, -15 );
+    path_line_to( ring, 15, -15 );
+    path_close( ring );
+
+    style.fill_color = (vec4) {{ 0.9, 0.2, 0.3, 1.0 }};
+    style.stroke_color = (vec4) {{ 0.0, 0.0, 0.0, 1.0 }};
+    style.thickness = 1.5;
+    style.join = round_join;
+    style.cap = round_cap;
+    style.miter_limit = 4.0;
+    build( );
+
+    glutMainLoop();
+    return 0;
+}
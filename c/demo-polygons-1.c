@@ -0,0 +1,150 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include "gl-agg.h"
+
+
+
+// ------------------------------------------------------- global variables ---
+vertex_buffer_t *buffer;
+GLuint program;
+matrix_t projection;
+matrix_t modelview;
+
+
+// --------------------------------------------------------------- reshape ---
+void reshape(int width, int height)
+{
+    glViewport( 0, 0, width, height );
+
+    matrix_load_identity( &projection );
+    matrix_ortho( &projection, 0, width, 0, height, -1000, +1000 );
+    matrix_load_identity( &modelview );
+
+    glMatrixMode( GL_PROJECTION );
+    glLoadMatrixf( projection.data );
+
+    glMatrixMode( GL_MODELVIEW );
+    glLoadMatrixf( modelview.data );
+
+    glutPostRedisplay( );
+}
+
+// --------------------------------------------------------------- keyboard ---
+void keyboard( unsigned char key, int x, int y )
+{
+    if ( key == 27 )
+    {
+        exit( EXIT_SUCCESS );
+    }
+}
+
+
+// ---------------------------------------------------------------- display ---
+void
+display( void )
+{
+    glClearColor( 1.0, 1.0, 1.0, 1.0 );
+    glClear( GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT );
+    glEnable( GL_BLEND );
+    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram( program );
+    vertex_buffer_render( buffer, GL_TRIANGLES, "vtc" );
+    glUseProgram( 0 );
+    glutSwapBuffers();
+}
+
+
+
+// ------------------------------------------------------------------- main ---
+int
+main( int argc, char **argv )
+{
+    glutInit( &argc, argv );
+    glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+    glutInitWindowSize( 512, 512) ;
+    glutCreateWindow( argv[0] );
+    glutDisplayFunc( display );
+    glutReshapeFunc( reshape );
+    glutKeyboardFunc( keyboard );
+
+    buffer = vertex_buffer_new( "v3f:c4f:t3f" ); 
+    program = shader_load( "shaders/line-aa.vert",
+                           "shaders/line-aa-round.frag" );
+    polygon_tessellator_t * tessellator = polygon_tessellator_new( );
+
+    // Star
+    vec2 star[10];
+    size_t i;
+    for( i=0; i<10; ++i )
+    {
+        double theta = i*M_PI/5 + M_PI/2;
+        double radius = (i%2) ? 40 : 100;
+        star[i].x = 130 + radius*cos( theta );
+        star[i].y = 380 + radius*sin( theta );
+    }
+    size_t star_counts[] = { 10 };
+    vertex_buffer_add_polygon( buffer, tessellator, star, star_counts, 1,
+                               (vec4) {{ 0.2, 0.4, 0.8, 1.0 }} );
+
+    // Square with two holes and its outline
+    vec2 square[] = { {{ 270, 290 }}, {{ 490, 290 }}, {{ 490, 490 }}, {{ 270, 490 }},
+                      {{ 300, 320 }}, {{ 300, 400 }}, {{ 380, 400 }}, {{ 380, 320 }},
+                      {{ 420, 350 }}, {{ 460, 430 }}, {{ 400, 460 }} };
+    size_t square_counts[] = { 4, 4, 3 };
+    vertex_buffer_add_polygon( buffer, tessellator, square, square_counts, 3,
+                               (vec4) {{ 0.8, 0.1, 0.1, 0.5 }} );
+    vertex_buffer_add_polyline( buffer, square, 4, (vec4) {{ 0, 0, 0, 1 }},
+                                2.0, miter_join, butt_cap, 4.0, 1 );
+
+    // Regular polygons and stars of increasing size
+    for( i=0; i<48; ++i )
+    {
+        vec2 points[16];
+        size_t j, n = 3 + i%8;
+        double radius = 4 + i/2.0;
+        for( j=0; j<n; ++j )
+        {
+            double theta = 2*M_PI*j/n + i*0.3;
+            double r = ((j%2) && (n > 5)) ? radius/2 : radius;
+            points[j].x = 30 + (i%12)*40 + r*cos( theta );
+            points[j].y = 50 + (i/12)*55 + r*sin( theta );
+        }
+        vertex_buffer_add_polygon( buffer, tessellator, points, &n, 1,
+                                   (vec4) {{ 0, 0, 0, 1 }} );
+    }
+    polygon_tessellator_delete( tessellator );
+
+    glutMainLoop();
+    return 0;
+}
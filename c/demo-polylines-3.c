@@ -0,0 +1,148 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include "gl-agg.h"
+#include "polyline-buffer.h"
+
+
+
+// ------------------------------------------------------- global variables ---
+polyline_buffer_t *buffer;
+GLuint program;
+matrix_t projection;
+matrix_t modelview;
+
+
+// --------------------------------------------------------------- reshape ---
+void reshape(int width, int height)
+{
+    glViewport( 0, 0, width, height );
+
+    matrix_load_identity( &projection );
+    matrix_ortho( &projection, 0, width, 0, height, -1000, +1000 );
+    matrix_load_identity( &modelview );
+
+    glMatrixMode( GL_PROJECTION );
+    glLoadMatrixf( projection.data );
+
+    glMatrixMode( GL_MODELVIEW );
+    glLoadMatrixf( modelview.data );
+
+    glutPostRedisplay( );
+}
+
+// --------------------------------------------------------------- keyboard ---
+void keyboard( unsigned char key, int x, int y )
+{
+    if ( key == 27 )
+    {
+        exit( EXIT_SUCCESS );
+    }
+}
+
+
+// ---------------------------------------------------------------- display ---
+void
+display( void )
+{
+    glClearColor( 1.0, 1.0, 1.0, 1.0 );
+    glClear( GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT );
+    glEnable( GL_BLEND );
+    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    polyline_buffer_render( buffer, program );
+    glUseProgram( 0 );
+    glutSwapBuffers();
+}
+
+
+// ------------------------------------------------------------------ idle ---
+void
+idle( void )
+{
+    // Only the points are uploaded again, the path table is left untouched
+    float t = glutGet( GLUT_ELAPSED_TIME ) / 1000.0;
+    float x0 = 30;
+    float y0 = 210;
+    size_t i, j;
+    for( i=0; i<3; ++i )
+    {
+        vec2 points[6];
+        for( j=0; j<6; ++j )
+        {
+            points[j].x = x0 + j*40;
+            points[j].y = y0 - i*80 + ((j%2) ? -10 : 10) * cos( t + j );
+        }
+        polyline_buffer_set_points( buffer, i, points );
+    }
+    glutPostRedisplay( );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int
+main( int argc, char **argv )
+{
+    glutInit( &argc, argv );
+    glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+    glutInitWindowSize( 256, 256) ;
+    glutCreateWindow( argv[0] );
+    glutDisplayFunc( display );
+    glutReshapeFunc( reshape );
+    glutKeyboardFunc( keyboard );
+    glutIdleFunc( idle );
+
+    buffer = polyline_buffer_new( );
+    program = shader_load( "shaders/polyline.vert",
+                           "shaders/polyline.frag" );
+
+    vec4 color = {{0,0,0,1}};
+    float thickness = 32;
+    float x0 = 30;
+    float y0 = 210;
+    size_t i;
+    for( i=0; i<3; ++i )
+    {
+        vec2 points[] = { {{ x0+  0, y0+10 }},
+                          {{ x0+ 40, y0-10 }},
+                          {{ x0+ 80, y0+10 }},
+                          {{ x0+120, y0-10 }},
+                          {{ x0+160, y0+10 }},
+                          {{ x0+200, y0-10 }} };
+        polyline_buffer_append( buffer, points, 6, color, thickness,
+                                i, (i == 2) ? round_cap : square_cap, 4.0, 0 );
+        y0 -= 80;
+    }
+
+    glutMainLoop();
+    return 0;
+}
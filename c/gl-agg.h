@@ -44,6 +44,14 @@
 #include "line.h"
 #include "curve.h"
 #include "circle.h"
+#include "polyline.h"
+#include "polygon.h"
+#include "path.h"
+#include "clip.h"
+#include "spatial-index.h"
+#include "vertex-cache.h"
+#include "upload-queue.h"
+#include "scene.h"
 #include "vector.h"
 #include "vec234.h"
 #include "matrix.h"
@@ -55,13 +55,22 @@ vertex_buffer_add_line( vertex_buffer_t * self,
     } vertex_t;
 
     assert( self );
-    assert( strcmp( vertex_buffer_format( self ), "v3f:c4f:t3f" ) == 0 );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
 
     size_t n = 2;
     int n_vertices = 2*n+2+2;
-    vertex_t * vertices = (vertex_t *) calloc( n_vertices, sizeof(vertex_t) );
+    vertex_t * vertices = (vertex_t *)
+        allocator_alloc( self->scratch, n_vertices*sizeof(vertex_t) );
+    memset( vertices, 0, n_vertices*sizeof(vertex_t) );
     int n_indices  = 6*(n+1);
-    GLuint * indices = (GLuint *) calloc( n_indices, sizeof(GLuint) );
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        // A single strip over all the vertices, plus a restart index
+        n_indices = n_vertices+1;
+    }
+    GLuint * indices = (GLuint *)
+        allocator_alloc( self->scratch, n_indices*sizeof(GLuint) );
+    memset( indices, 0, n_indices*sizeof(GLuint) );
 
     float d,w;
     if (thickness < 1.0)
@@ -150,19 +159,30 @@ vertex_buffer_add_line( vertex_buffer_t * self,
     index++;
 
     size_t i;
-    for(i=0; i<=n; ++i)
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        for(i=0; i<n_vertices; ++i)
+        {
+            indices[i] = i;
+        }
+        indices[n_vertices] = VERTEX_BUFFER_RESTART_INDEX;
+    }
+    else
     {
-        indices[6*i+0] = 2*i+0;
-        indices[6*i+1] = 2*i+1;
-        indices[6*i+2] = 2*i+2;
-        indices[6*i+3] = 2*i+1;
-        indices[6*i+4] = 2*i+2;
-        indices[6*i+5] = 2*i+3;
+        for(i=0; i<=n; ++i)
+        {
+            indices[6*i+0] = 2*i+0;
+            indices[6*i+1] = 2*i+1;
+            indices[6*i+2] = 2*i+2;
+            indices[6*i+3] = 2*i+1;
+            indices[6*i+4] = 2*i+2;
+            indices[6*i+5] = 2*i+3;
+        }
     }
 
     vertex_buffer_append( self, vertices, n_vertices, indices,  n_indices );
-    free( indices );
-    free( vertices );
+    allocator_free( self->scratch, indices, n_indices*sizeof(GLuint) );
+    allocator_free( self->scratch, vertices, n_vertices*sizeof(vertex_t) );
 }
 
 
@@ -175,7 +195,7 @@ vertex_buffer_add_line_2( vertex_buffer_t * self,
                           vec4 color, double thickness )
 {
     assert( self );
-    assert( strcmp( vertex_buffer_format( self ), "v3f:c4f:t4f" ) == 0 );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T4F );
     typedef struct { vec3 vertex; vec4 color; vec4 tex_coord; } vertex_t;
 
     float support = 1.0;
@@ -193,6 +213,17 @@ vertex_buffer_add_line_2( vertex_buffer_t * self,
          { {{x1-dy+dx, y1+dx+dy}}, color, {{length+w/2, +w/2, thickness, length}} },
          { {{x1+dy+dx, y1-dx+dy}}, color, {{length+w/2, -w/2, thickness, length}} } };
     GLuint indices[6] = {0,1,2,0,2,3};
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        GLuint strip[5] = {1,0,2,3,VERTEX_BUFFER_RESTART_INDEX};
+        vertex_buffer_append( self, vertices, 4, strip, 5 );
+        return;
+    }
+    if( self->primitive == GL_QUADS )
+    {
+        vertex_buffer_append( self, vertices, 4, 0, 0 );
+        return;
+    }
 
     vertex_buffer_append( self, vertices, 4, indices, 6 );
 }
@@ -0,0 +1,478 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "curve.h"
+#include "polyline.h"
+#include "path.h"
+
+
+// --------------------------------------------------- typedefs and structs ---
+typedef struct { float x,y,z,r,g,b,a,s,t,u; } vertex_t;
+
+
+// --------------------------------------------------------------- path_new ---
+path_t *
+path_new( void )
+{
+    path_t *self = (path_t *) malloc( sizeof(path_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->commands = vector_new( sizeof(unsigned char) );
+    self->coords   = vector_new( sizeof(vec2) );
+    self->points   = vector_new( sizeof(vec2) );
+    self->contours = vector_new( sizeof(size_t) );
+    self->closed   = vector_new( sizeof(unsigned char) );
+    self->bbox = (vec4) {{ 0, 0, 0, 0 }};
+    self->flattened = 1;
+    self->fill   = vertex_buffer_new( "v3f:c4f:t3f" );
+    self->stroke = vertex_buffer_new( "v3f:c4f:t3f" );
+    memset( &self->style, 0, sizeof(path_style_t) );
+    self->fill_compiled = 0;
+    self->stroke_compiled = 0;
+    self->tessellator = 0;
+    return self;
+}
+
+
+// ------------------------------------------------------------ path_delete ---
+void
+path_delete( path_t * self )
+{
+    assert( self );
+
+    vector_delete( self->commands );
+    vector_delete( self->coords );
+    vector_delete( self->points );
+    vector_delete( self->contours );
+    vector_delete( self->closed );
+    vertex_buffer_delete( self->fill );
+    vertex_buffer_delete( self->stroke );
+    if( self->tessellator )
+    {
+        polygon_tessellator_delete( self->tessellator );
+    }
+    free( self );
+}
+
+
+// ------------------------------------------------------------- path_clear ---
+void
+path_clear( path_t * self )
+{
+    assert( self );
+
+    vector_clear( self->commands );
+    vector_clear( self->coords );
+    self->flattened = 0;
+}
+
+
+// ----------------------------------------------------------- path_command ---
+void
+path_command( path_t * self, unsigned char command,
+              const vec2 * coords, size_t count )
+{
+    assert( self );
+    assert( (command == move_to_command) || vector_size( self->commands ) );
+
+    vector_push_back( self->commands, &command );
+    if( count )
+    {
+        vector_push_back_data( self->coords, coords, count );
+    }
+    self->flattened = 0;
+}
+
+
+// ----------------------------------------------------------- path_move_to ---
+void
+path_move_to( path_t * self, float x, float y )
+{
+    vec2 coords[1] = { {{x,y}} };
+    path_command( self, move_to_command, coords, 1 );
+}
+
+
+// ----------------------------------------------------------- path_line_to ---
+void
+path_line_to( path_t * self, float x, float y )
+{
+    vec2 coords[1] = { {{x,y}} };
+    path_command( self, line_to_command, coords, 1 );
+}
+
+
+// ----------------------------------------------------------- path_quad_to ---
+void
+path_quad_to( path_t * self,
+              float x1, float y1,
+              float x2, float y2 )
+{
+    vec2 coords[2] = { {{x1,y1}}, {{x2,y2}} };
+    path_command( self, quad_to_command, coords, 2 );
+}
+
+
+// ---------------------------------------------------------- path_cubic_to ---
+void
+path_cubic_to( path_t * self,
+               float x1, float y1,
+               float x2, float y2,
+               float x3, float y3 )
+{
+    vec2 coords[3] = { {{x1,y1}}, {{x2,y2}}, {{x3,y3}} };
+    path_command( self, cubic_to_command, coords, 3 );
+}
+
+
+// ------------------------------------------------------------- path_close ---
+void
+path_close( path_t * self )
+{
+    path_command( self, close_command, 0, 0 );
+}
+
+
+// ------------------------------------------------------- path_end_contour ---
+// Terminates the subpath starting at the given point: duplicated points are
+// removed and subpaths with less than two points are dropped.
+void
+path_end_contour( path_t * self, size_t first, int closed )
+{
+    vec2 * P = (vec2 *) self->points->items;
+    size_t i, n = first;
+
+    if( first == self->points->size )
+    {
+        return;
+    }
+    for( i=first+1; i<self->points->size; ++i )
+    {
+        if( (P[i].x != P[n].x) || (P[i].y != P[n].y) )
+        {
+            P[++n] = P[i];
+        }
+    }
+    if( closed && (n > first) &&
+        (P[n].x == P[first].x) && (P[n].y == P[first].y) )
+    {
+        n--;
+    }
+    size_t count = n+1 - first;
+    if( count < 2 )
+    {
+        self->points->size = first;
+        return;
+    }
+    self->points->size = first + count;
+
+    unsigned char c = closed ? 1 : 0;
+    size_vector_push_back( self->contours, count );
+    vector_push_back( self->closed, &c );
+}
+
+
+// ----------------------------------------------------------- path_flatten ---
+void
+path_flatten( path_t * self )
+{
+    const unsigned char * commands = (const unsigned char *) self->commands->items;
+    const vec2 * coords = (const vec2 *) self->coords->items;
+    vector_t * points = self->points;
+    size_t i, k = 0, first = 0, n = vector_size( self->commands );
+    vec2 start = {{ 0, 0 }}, last;
+
+    vector_clear( points );
+    vector_clear( self->contours );
+    vector_clear( self->closed );
+
+    for( i=0; i<n; ++i )
+    {
+        // A command following a close starts a new subpath at the same point
+        if( (commands[i] != move_to_command) && (points->size == first) )
+        {
+            vec2_vector_push_back( points, start );
+        }
+        last = (points->size > first)
+             ? vec2_vector_get( points, points->size-1 ) : start;
+
+        switch( commands[i] )
+        {
+        case move_to_command:
+            path_end_contour( self, first, 0 );
+            first = points->size;
+            start = coords[k++];
+            vec2_vector_push_back( points, start );
+            break;
+
+        case line_to_command:
+            vec2_vector_push_back( points, coords[k++] );
+            break;
+
+        case quad_to_command:
+            curve3_flatten( points, last.x, last.y,
+                            coords[k].x, coords[k].y,
+                            coords[k+1].x, coords[k+1].y );
+            k += 2;
+            break;
+
+        case cubic_to_command:
+            curve4_flatten( points, last.x, last.y,
+                            coords[k].x, coords[k].y,
+                            coords[k+1].x, coords[k+1].y,
+                            coords[k+2].x, coords[k+2].y );
+            k += 3;
+            break;
+
+        case close_command:
+            path_end_contour( self, first, 1 );
+            first = points->size;
+            break;
+        }
+    }
+    path_end_contour( self, first, 0 );
+
+    // Bounding box
+    const vec2 * P = (const vec2 *) points->items;
+    vec4 bbox = {{ 0, 0, 0, 0 }};
+    if( points->size )
+    {
+        float xmin = P[0].x, xmax = P[0].x, ymin = P[0].y, ymax = P[0].y;
+        for( i=1; i<points->size; ++i )
+        {
+            if( P[i].x < xmin ) xmin = P[i].x;
+            if( P[i].x > xmax ) xmax = P[i].x;
+            if( P[i].y < ymin ) ymin = P[i].y;
+            if( P[i].y > ymax ) ymax = P[i].y;
+        }
+        bbox = (vec4) {{ xmin, ymin, xmax-xmin, ymax-ymin }};
+    }
+    self->bbox = bbox;
+    self->flattened = 1;
+    self->fill_compiled = 0;
+    self->stroke_compiled = 0;
+}
+
+
+// ------------------------------------------------------------ path_bounds ---
+vec4
+path_bounds( path_t * self )
+{
+    assert( self );
+
+    if( !self->flattened )
+    {
+        path_flatten( self );
+    }
+    return self->bbox;
+}
+
+
+// ------------------------------------------------------- path_color_equal ---
+int
+path_color_equal( vec4 a, vec4 b )
+{
+    return (a.r == b.r) && (a.g == b.g) && (a.b == b.b) && (a.a == b.a);
+}
+
+
+// ----------------------------------------------------------- path_recolor ---
+void
+path_recolor( vertex_buffer_t * buffer, vec4 color )
+{
+    vertex_t * vertices = (vertex_t *) buffer->vertices->items;
+    size_t i;
+
+    for( i=0; i<buffer->vertices->size; ++i )
+    {
+        vertices[i].r = color.r;
+        vertices[i].g = color.g;
+        vertices[i].b = color.b;
+        vertices[i].a = color.a;
+    }
+}
+
+
+// ----------------------------------------------------------- path_compile ---
+void
+path_compile( path_t * self,
+              const path_style_t * style,
+              GLenum primitive )
+{
+    assert( self );
+    assert( style );
+
+    path_style_t * old = &self->style;
+    const vec2 * points = (const vec2 *) self->points->items;
+    const size_t * contours = (const size_t *) self->contours->items;
+    const unsigned char * closed = (const unsigned char *) self->closed->items;
+    size_t i;
+
+    if( !self->flattened )
+    {
+        path_flatten( self );
+        points = (const vec2 *) self->points->items;
+        contours = (const size_t *) self->contours->items;
+        closed = (const unsigned char *) self->closed->items;
+    }
+    if( self->fill->primitive != primitive )
+    {
+        vertex_buffer_clear( self->fill );
+        vertex_buffer_clear( self->stroke );
+        vertex_buffer_set_primitive( self->fill, primitive );
+        vertex_buffer_set_primitive( self->stroke, primitive );
+        self->fill_compiled = 0;
+        self->stroke_compiled = 0;
+    }
+
+    // Fill: only a color change can be handled without tessellating again
+    int fill = (style->fill_color.a > 0);
+    if( !self->fill_compiled || (fill != (old->fill_color.a > 0)) )
+    {
+        vertex_buffer_clear( self->fill );
+        if( fill && self->contours->size )
+        {
+            if( !self->tessellator )
+            {
+                self->tessellator = polygon_tessellator_new( );
+            }
+            vertex_buffer_add_polygon( self->fill, self->tessellator,
+                                       points, contours, self->contours->size,
+                                       style->fill_color );
+        }
+        self->fill_compiled = 1;
+    }
+    else if( fill && !path_color_equal( style->fill_color, old->fill_color ) )
+    {
+        path_recolor( self->fill, style->fill_color );
+    }
+
+    // Stroke: same for the color, with thin lines alpha scaled as in
+    // polyline_tessellate
+    int stroke = (style->stroke_color.a > 0) && (style->thickness > 0);
+    int old_stroke = (old->stroke_color.a > 0) && (old->thickness > 0);
+    if( !self->stroke_compiled || (stroke != old_stroke) ||
+        (stroke && ( (style->thickness != old->thickness) ||
+                     (style->join != old->join) ||
+                     (style->cap != old->cap) ||
+                     (style->miter_limit != old->miter_limit) )) )
+    {
+        vertex_buffer_clear( self->stroke );
+        if( stroke )
+        {
+            size_t start = 0;
+            for( i=0; i<self->contours->size; ++i )
+            {
+                vertex_buffer_add_polyline( self->stroke,
+                                            points + start, contours[i],
+                                            style->stroke_color,
+                                            style->thickness,
+                                            style->join, style->cap,
+                                            style->miter_limit, closed[i] );
+                start += contours[i];
+            }
+        }
+        self->stroke_compiled = 1;
+    }
+    else if( stroke &&
+             !path_color_equal( style->stroke_color, old->stroke_color ) )
+    {
+        vec4 color = style->stroke_color;
+        if( style->thickness < 1.0 )
+        {
+            color.a *= style->thickness;
+        }
+        path_recolor( self->stroke, color );
+    }
+    self->style = *style;
+}
+
+
+// ------------------------------------------------- vertex_buffer_add_path ---
+void
+vertex_buffer_add_path( vertex_buffer_t * self,
+                        path_t * path,
+                        const path_style_t * style,
+                        vec2 offset )
+{
+    assert( self );
+    assert( path );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
+
+    path_compile( path, style, self->primitive );
+
+    vector_t * parts[2] = { path->fill->vertices, path->stroke->vertices };
+    vector_t * indices_[2] = { path->fill->indices, path->stroke->indices };
+    size_t vcount = parts[0]->size + parts[1]->size;
+    size_t icount = indices_[0]->size + indices_[1]->size;
+    size_t i, j, v = 0, k = 0;
+    void * data;
+    GLuint * indices;
+
+    if( !vcount )
+    {
+        return;
+    }
+    GLuint base = vertex_buffer_reserve_item( self, vcount, icount,
+                                              &data, &indices );
+    vertex_t * vertices = (vertex_t *) data;
+
+    // Copy the compiled geometry at the given offset
+    for( j=0; j<2; ++j )
+    {
+        const GLuint * I = (const GLuint *) indices_[j]->items;
+        for( i=0; i<indices_[j]->size; ++i )
+        {
+            indices[k++] = (I[i] == VERTEX_BUFFER_RESTART_INDEX)
+                         ? VERTEX_BUFFER_RESTART_INDEX : I[i] + base + v;
+        }
+        memcpy( vertices + v, parts[j]->items, parts[j]->size*sizeof(vertex_t) );
+        v += parts[j]->size;
+    }
+    if( (offset.x != 0) || (offset.y != 0) )
+    {
+        for( i=0; i<vcount; ++i )
+        {
+            vertices[i].x += offset.x;
+            vertices[i].y += offset.y;
+        }
+    }
+    vertex_buffer_commit_item( self, vcount, icount );
+}
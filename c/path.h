@@ -0,0 +1,289 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __PATH_H__
+#define __PATH_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+#include "vertex-buffer.h"
+#include "polygon.h"
+
+
+/**
+ * @file   path.h
+ *
+ * @defgroup path Path
+ *
+ * A path records move-to, line-to, quad-to, cubic-to and close commands
+ * (one byte per command plus its points). It is flattened once using the
+ * curve flattener and compiled into fill geometry (see polygon.h) and
+ * stroke geometry (see polyline.h), both being cached by the path:
+ *
+ *  - the flattened points and the bounding box are recomputed only when
+ *    commands are added,
+ *  - compiling with a new style only redoes the work that depends on the
+ *    style change: a color change rewrites the colors of the cached
+ *    vertices, a thickness, join, cap or miter change re-strokes the path
+ *    and leaves its fill untouched,
+ *  - adding the same path several times (repeated symbols) copies the
+ *    compiled geometry at the given offsets without tessellating again.
+ *
+ * The first subpath is the outline of the fill and the other ones are holes
+ * (see polygon.h). Vertex format is "v3f:c4f:t3f" and the "line-aa-round"
+ * fragment shader renders both fill and stroke.
+ *
+ * Example Usage:
+ * @code
+ * path_t * path = path_new( );
+ * path_move_to( path, 0, 0 );
+ * path_cubic_to( path, 50, 100, 100, -100, 150, 0 );
+ * path_close( path );
+ * vertex_buffer_add_path( buffer, path, &style, (vec2) {{ 10, 10 }} );
+ * vertex_buffer_add_path( buffer, path, &style, (vec2) {{ 10, 60 }} );
+ * path_delete( path );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Path commands
+ */
+enum path_command_e
+{
+    move_to_command  = 0,
+    line_to_command  = 1,
+    quad_to_command  = 2,
+    cubic_to_command = 3,
+    close_command    = 4
+};
+
+
+/**
+ * Path style.
+ */
+typedef struct
+{
+    /** Fill color (no fill if alpha is 0). */
+    vec4 fill_color;
+
+    /** Stroke color (no stroke if alpha is 0). */
+    vec4 stroke_color;
+
+    /** Stroke thickness (no stroke if 0). */
+    float thickness;
+
+    /** One of bevel_join, miter_join or round_join. */
+    int join;
+
+    /** One of square_cap, butt_cap or round_cap. */
+    int cap;
+
+    /** Maximum ratio of miter length to half thickness. */
+    float miter_limit;
+} path_style_t;
+
+
+/**
+ * Path.
+ */
+typedef struct
+{
+    /** Commands (one unsigned char each). */
+    vector_t * commands;
+
+    /** Points of the commands (vec2). */
+    vector_t * coords;
+
+    /** Flattened points of all subpaths (vec2). */
+    vector_t * points;
+
+    /** Number of flattened points of each subpath (size_t). */
+    vector_t * contours;
+
+    /** Whether each subpath is closed (unsigned char). */
+    vector_t * closed;
+
+    /** Bounding box of the flattened points (x, y, width, height). */
+    vec4 bbox;
+
+    /** Whether points, contours and bbox are up to date. */
+    int flattened;
+
+    /** Cached fill geometry. */
+    vertex_buffer_t * fill;
+
+    /** Cached stroke geometry. */
+    vertex_buffer_t * stroke;
+
+    /** Style the cached geometry has been compiled with. */
+    path_style_t style;
+
+    /** Whether the cached fill geometry is up to date (but its color). */
+    int fill_compiled;
+
+    /** Whether the cached stroke geometry is up to date (but its color). */
+    int stroke_compiled;
+
+    /** Polygon tessellator used for the fill (created when needed). */
+    polygon_tessellator_t * tessellator;
+} path_t;
+
+
+/**
+ * Creates a new empty path.
+ *
+ * @return  a new empty path
+ */
+  path_t *
+  path_new( void );
+
+
+/**
+ * Deletes a path.
+ *
+ * @param  self  a path
+ */
+  void
+  path_delete( path_t * self );
+
+
+/**
+ * Removes all commands of a path.
+ *
+ * @param  self  a path
+ */
+  void
+  path_clear( path_t * self );
+
+
+/**
+ * Starts a new subpath at the given point.
+ *
+ * @param  self  a path
+ * @param  x,y   start point
+ */
+  void
+  path_move_to( path_t * self, float x, float y );
+
+
+/**
+ * Adds a straight segment from the current point.
+ *
+ * @param  self  a path
+ * @param  x,y   end point
+ */
+  void
+  path_line_to( path_t * self, float x, float y );
+
+
+/**
+ * Adds a quadratic bezier curve from the current point.
+ *
+ * @param  self   a path
+ * @param  x1,y1  control point
+ * @param  x2,y2  end point
+ */
+  void
+  path_quad_to( path_t * self,
+                float x1, float y1,
+                float x2, float y2 );
+
+
+/**
+ * Adds a cubic bezier curve from the current point.
+ *
+ * @param  self   a path
+ * @param  x1,y1  first control point
+ * @param  x2,y2  second control point
+ * @param  x3,y3  end point
+ */
+  void
+  path_cubic_to( path_t * self,
+                 float x1, float y1,
+                 float x2, float y2,
+                 float x3, float y3 );
+
+
+/**
+ * Closes the current subpath.
+ *
+ * @param  self  a path
+ */
+  void
+  path_close( path_t * self );
+
+
+/**
+ * Returns the bounding box of a path (cached).
+ *
+ * @param  self  a path
+ * @return       bounding box (x, y, width, height) of the flattened path
+ */
+  vec4
+  path_bounds( path_t * self );
+
+
+/**
+ * Compiles a path into its cached fill and stroke geometry, redoing only
+ * what depends on what changed since the last compilation.
+ *
+ * @param  self       a path
+ * @param  style      path style
+ * @param  primitive  GL_TRIANGLES or GL_TRIANGLE_STRIP
+ */
+  void
+  path_compile( path_t * self,
+                const path_style_t * style,
+                GLenum primitive );
+
+
+/**
+ * Add a path to a vertex buffer as a single item, compiling it if needed.
+ *
+ * @param  self    a vertex buffer with format "v3f:c4f:t3f"
+ * @param  path    a path
+ * @param  style   path style
+ * @param  offset  translation applied to the path
+ */
+  void
+  vertex_buffer_add_path( vertex_buffer_t * self,
+                          path_t * path,
+                          const path_style_t * style,
+                          vec2 offset );
+
+/** @} */
+
+#endif /* __PATH_H__ */
@@ -0,0 +1,973 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "polygon.h"
+
+
+#define max(a,b) ( (a)>(b) ? (a) : (b) )
+
+
+// --------------------------------------------------- typedefs and structs ---
+typedef struct { float x,y,z,r,g,b,a,s,t,u; } vertex_t;
+
+// Vertex of the monotone partition. A diagonal duplicates its two endpoints
+// such that every piece remains a simple cycle of next/prev links.
+typedef struct
+{
+    vec2   p;
+    size_t id;         // index into points
+    size_t prev;
+    size_t next;
+    size_t helper;     // helper of the edge (this, next)
+    size_t node;       // status node of the edge (this, next), or NONE
+    char   type;
+    char   used;
+} polygon_vertex_t;
+
+// Node of the sweep line status, a treap of the edges ordered from left to
+// right (as binary search tree) and by priority (as heap). Node 0 is a
+// header whose left child is the root.
+typedef struct
+{
+    size_t   edge;     // vertex starting the edge
+    size_t   left;
+    size_t   right;
+    size_t   parent;
+    uint32_t priority;
+} polygon_node_t;
+
+enum polygon_vertex_e
+{
+    regular_vertex = 0,
+    start_vertex   = 1,
+    end_vertex     = 2,
+    split_vertex   = 3,
+    merge_vertex   = 4
+};
+
+// Polygons without holes up to this size are ear clipped
+#define EAR_CLIPPING_MAX 16
+
+// Width of the anti-aliased fringe (pixels) and maximum miter of its corners
+#define FRINGE       1.0
+#define FRINGE_MITER 4.0
+
+#define EPSILON 1e-6
+#define NONE    ((size_t) -1)
+
+
+// ------------------------------------------------ polygon_tessellator_new ---
+polygon_tessellator_t *
+polygon_tessellator_new( void )
+{
+    polygon_tessellator_t *self =
+        (polygon_tessellator_t *) malloc( sizeof(polygon_tessellator_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->points    = vector_new( sizeof(vec2) );
+    self->rings     = vector_new( sizeof(size_t) );
+    self->vertices  = vector_new( sizeof(polygon_vertex_t) );
+    self->queue     = vector_new( sizeof(polygon_vertex_t *) );
+    self->status    = vector_new( sizeof(size_t) );
+    self->scratch   = vector_new( sizeof(size_t) );
+    self->triangles = vector_new( sizeof(GLuint) );
+    return self;
+}
+
+
+// --------------------------------------------- polygon_tessellator_delete ---
+void
+polygon_tessellator_delete( polygon_tessellator_t * self )
+{
+    assert( self );
+
+    vector_delete( self->points );
+    vector_delete( self->rings );
+    vector_delete( self->vertices );
+    vector_delete( self->queue );
+    vector_delete( self->status );
+    vector_delete( self->scratch );
+    vector_delete( self->triangles );
+    free( self );
+}
+
+
+// ----------------------------------------------------------- polygon_grow ---
+static void
+polygon_grow( vector_t * vector, size_t size )
+{
+    if( vector->capacity < size )
+    {
+        vector_reserve( vector, max( 2*vector->capacity, size ) );
+    }
+}
+
+
+// ---------------------------------------------------------- polygon_below ---
+// Sweep order: from top to bottom, then from right to left
+static int
+polygon_below( vec2 a, vec2 b )
+{
+    return (a.y < b.y) || ((a.y == b.y) && (a.x < b.x));
+}
+
+
+// --------------------------------------------------------- polygon_convex ---
+static int
+polygon_convex( vec2 a, vec2 b, vec2 c )
+{
+    return ((double) (c.y-a.y)*(b.x-a.x) - (double) (c.x-a.x)*(b.y-a.y)) > 0;
+}
+
+
+// ------------------------------------------------------ polygon_edge_less ---
+// Whether edge (a1,a2) lies on the left of edge (b1,b2) on the sweep line
+static int
+polygon_edge_less( vec2 a1, vec2 a2, vec2 b1, vec2 b2 )
+{
+    if( b1.y == b2.y )
+    {
+        if( a1.y == a2.y )
+        {
+            return a1.y < b1.y;
+        }
+        return polygon_convex( a1, a2, b1 );
+    }
+    else if( (a1.y == a2.y) || (a1.y < b1.y) )
+    {
+        return !polygon_convex( b1, b2, a1 );
+    }
+    return polygon_convex( a1, a2, b1 );
+}
+
+
+// ------------------------------------------------------- polygon_triangle ---
+static void
+polygon_triangle( polygon_tessellator_t * self,
+                  size_t a, size_t b, size_t c )
+{
+    polygon_grow( self->triangles, self->triangles->size + 3 );
+    GLuint * i = (GLuint *) self->triangles->items + self->triangles->size;
+    i[0] = a; i[1] = b; i[2] = c;
+    self->triangles->size += 3;
+}
+
+
+// ------------------------------------------------------- polygon_ear_clip ---
+// Triangulates a counter-clockwise simple ring of m points
+static void
+polygon_ear_clip( polygon_tessellator_t * self,
+                  const size_t * ids, size_t m,
+                  size_t * prev, size_t * next )
+{
+    const vec2 * P = (const vec2 *) self->points->items;
+    size_t i, j, remaining = m, tries = 0;
+
+    for( i=0; i<m; ++i )
+    {
+        prev[i] = (i+m-1) % m;
+        next[i] = (i+1) % m;
+    }
+    i = 0;
+    while( remaining > 3 )
+    {
+        size_t a = prev[i], c = next[i];
+        vec2 A = P[ids[a]], B = P[ids[i]], C = P[ids[c]];
+        int ear = polygon_convex( A, B, C );
+        for( j=next[c]; ear && (j != a); j=next[j] )
+        {
+            vec2 Q = P[ids[j]];
+            if( (Q.x == A.x && Q.y == A.y) || (Q.x == B.x && Q.y == B.y) ||
+                (Q.x == C.x && Q.y == C.y) )
+            {
+                continue;
+            }
+            ear = !( polygon_convex( A, B, Q ) &&
+                     polygon_convex( B, C, Q ) &&
+                     polygon_convex( C, A, Q ) );
+        }
+        // A degenerate ring may have no ear left, clip anyway
+        if( ear || (tries > remaining) )
+        {
+            polygon_triangle( self, ids[a], ids[i], ids[c] );
+            next[a] = c;
+            prev[c] = a;
+            remaining--;
+            tries = 0;
+            i = c;
+        }
+        else
+        {
+            tries++;
+            i = c;
+        }
+    }
+    polygon_triangle( self, ids[prev[i]], ids[i], ids[next[i]] );
+}
+
+
+// ------------------------------------------------------- polygon_monotone ---
+// Triangulates a counter-clockwise y-monotone ring of m points or returns 0
+// if the ring is not monotone.
+static int
+polygon_monotone( polygon_tessellator_t * self,
+                  const size_t * ids, size_t m,
+                  size_t * order, size_t * chain, size_t * stack )
+{
+    const vec2 * P = (const vec2 *) self->points->items;
+    size_t i, j, top = 0, bottom = 0, left, right, n_stack;
+
+    if( m == 3 )
+    {
+        polygon_triangle( self, ids[0], ids[1], ids[2] );
+        return 1;
+    }
+    for( i=1; i<m; ++i )
+    {
+        if( polygon_below( P[ids[i]], P[ids[bottom]] ) ) bottom = i;
+        if( polygon_below( P[ids[top]], P[ids[i]] ) )    top = i;
+    }
+
+    // Both chains must go down from top to bottom
+    for( i=top; i != bottom; i=j )
+    {
+        j = (i+1) % m;
+        if( !polygon_below( P[ids[j]], P[ids[i]] ) ) return 0;
+    }
+    for( i=bottom; i != top; i=j )
+    {
+        j = (i+1) % m;
+        if( !polygon_below( P[ids[i]], P[ids[j]] ) ) return 0;
+    }
+
+    // Merge the left (1) and right (2) chains from top to bottom
+    order[0] = top;
+    chain[top] = 0;
+    left  = (top+1) % m;
+    right = (top+m-1) % m;
+    for( i=1; i<(m-1); ++i )
+    {
+        if( (left == bottom) ||
+            ((right != bottom) &&
+             polygon_below( P[ids[left]], P[ids[right]] )) )
+        {
+            order[i] = right;
+            chain[right] = 2;
+            right = (right+m-1) % m;
+        }
+        else
+        {
+            order[i] = left;
+            chain[left] = 1;
+            left = (left+1) % m;
+        }
+    }
+    order[m-1] = bottom;
+    chain[bottom] = 0;
+
+    stack[0] = order[0];
+    stack[1] = order[1];
+    n_stack = 2;
+    for( i=2; i<(m-1); ++i )
+    {
+        size_t v = order[i];
+        if( chain[v] != chain[stack[n_stack-1]] )
+        {
+            // Opposite chain: fan to the whole stack
+            for( j=0; j<(n_stack-1); ++j )
+            {
+                polygon_triangle( self, ids[stack[j]], ids[stack[j+1]], ids[v] );
+            }
+            stack[0] = order[i-1];
+            stack[1] = v;
+            n_stack = 2;
+        }
+        else
+        {
+            // Same chain: clip while the diagonal lies inside
+            n_stack--;
+            while( n_stack > 0 )
+            {
+                size_t s0 = stack[n_stack-1], s1 = stack[n_stack];
+                int inside = (chain[v] == 1)
+                    ? polygon_convex( P[ids[v]], P[ids[s0]], P[ids[s1]] )
+                    : polygon_convex( P[ids[v]], P[ids[s1]], P[ids[s0]] );
+                if( !inside )
+                {
+                    break;
+                }
+                polygon_triangle( self, ids[v], ids[s0], ids[s1] );
+                n_stack--;
+            }
+            n_stack++;
+            stack[n_stack++] = v;
+        }
+    }
+    for( j=0; j<(n_stack-1); ++j )
+    {
+        polygon_triangle( self, ids[stack[j]], ids[stack[j+1]], ids[order[m-1]] );
+    }
+    return 1;
+}
+
+
+// ---------------------------------------------------- polygon_status_link ---
+// Replaces child node c of node p by node n
+static void
+polygon_status_link( polygon_node_t * S, size_t p, size_t c, size_t n )
+{
+    if( S[p].left == c )
+    {
+        S[p].left = n;
+    }
+    else
+    {
+        S[p].right = n;
+    }
+    if( n != NONE )
+    {
+        S[n].parent = p;
+    }
+}
+
+
+// -------------------------------------------------- polygon_status_rotate ---
+// Moves node n above its parent
+static void
+polygon_status_rotate( polygon_node_t * S, size_t n )
+{
+    size_t p = S[n].parent;
+
+    polygon_status_link( S, S[p].parent, p, n );
+    if( S[p].left == n )
+    {
+        S[p].left = S[n].right;
+        if( S[n].right != NONE )
+        {
+            S[S[n].right].parent = p;
+        }
+        S[n].right = p;
+    }
+    else
+    {
+        S[p].right = S[n].left;
+        if( S[n].left != NONE )
+        {
+            S[S[n].left].parent = p;
+        }
+        S[n].left = p;
+    }
+    S[p].parent = n;
+}
+
+
+// -------------------------------------------------- polygon_status_insert ---
+static void
+polygon_status_insert( polygon_tessellator_t * self, size_t v )
+{
+    polygon_vertex_t * V = (polygon_vertex_t *) self->vertices->items;
+    polygon_node_t * S = (polygon_node_t *) self->status->items;
+    vec2 q1 = V[v].p, q2 = V[V[v].next].p;
+    size_t n = self->status->size++;
+    size_t p = 0, c = S[0].left;
+    int left = 1;
+
+    // Deterministic pseudo-random priority (integer hash of the node)
+    uint32_t h = (uint32_t) n;
+    h ^= h >> 16; h *= 0x7feb352d;
+    h ^= h >> 15; h *= 0x846ca68b;
+    h ^= h >> 16;
+
+    assert( self->status->size <= self->status->capacity );
+    while( c != NONE )
+    {
+        p = c;
+        left = !polygon_edge_less( V[S[c].edge].p, V[V[S[c].edge].next].p,
+                                   q1, q2 );
+        c = left ? S[c].left : S[c].right;
+    }
+    S[n].edge = v;
+    S[n].left = S[n].right = NONE;
+    S[n].parent = p;
+    S[n].priority = h;
+    if( left )
+    {
+        S[p].left = n;
+    }
+    else
+    {
+        S[p].right = n;
+    }
+    while( (S[n].parent != 0) && (S[S[n].parent].priority < h) )
+    {
+        polygon_status_rotate( S, n );
+    }
+    V[v].node = n;
+}
+
+
+// --------------------------------------------------- polygon_status_erase ---
+static void
+polygon_status_erase( polygon_tessellator_t * self, size_t v )
+{
+    polygon_vertex_t * V = (polygon_vertex_t *) self->vertices->items;
+    polygon_node_t * S = (polygon_node_t *) self->status->items;
+    size_t n = V[v].node;
+
+    // Moves the node down to a leaf or a single child, then unlinks it
+    while( (S[n].left != NONE) && (S[n].right != NONE) )
+    {
+        size_t l = S[n].left, r = S[n].right;
+        polygon_status_rotate( S, (S[l].priority > S[r].priority) ? l : r );
+    }
+    polygon_status_link( S, S[n].parent, n,
+                         (S[n].left != NONE) ? S[n].left : S[n].right );
+    V[v].node = NONE;
+}
+
+
+// ---------------------------------------------------- polygon_status_left ---
+// Status node of the edge directly on the left of P (or NONE)
+static size_t
+polygon_status_left( polygon_tessellator_t * self, vec2 P )
+{
+    const polygon_vertex_t * V = (const polygon_vertex_t *) self->vertices->items;
+    const polygon_node_t * S = (const polygon_node_t *) self->status->items;
+    size_t c = S[0].left, k = NONE;
+
+    while( c != NONE )
+    {
+        if( polygon_edge_less( V[S[c].edge].p, V[V[S[c].edge].next].p,
+                               P, P ) )
+        {
+            k = c;
+            c = S[c].right;
+        }
+        else
+        {
+            c = S[c].left;
+        }
+    }
+    return k;
+}
+
+
+// ------------------------------------------------------- polygon_diagonal ---
+// Adds diagonal (v1,v2), splitting a piece in two: v1 -> n2 -> (v2 next)
+// and v2 -> n1 -> (v1 next), where n1 and n2 are new copies of v1 and v2
+// that take over the edges (v, next). Seen from v1, the corner between the
+// diagonal and the incoming edge stays with v1 and the one between the
+// outgoing edge and the diagonal goes to n1.
+static void
+polygon_diagonal( polygon_tessellator_t * self, size_t v1, size_t v2 )
+{
+    polygon_vertex_t * V = (polygon_vertex_t *) self->vertices->items;
+    polygon_node_t * S = (polygon_node_t *) self->status->items;
+    size_t n1 = self->vertices->size++;
+    size_t n2 = self->vertices->size++;
+    size_t k1 = V[v1].node;
+    size_t k2 = V[v2].node;
+
+    assert( self->vertices->size <= self->vertices->capacity );
+    V[n1] = V[v1];
+    V[n2] = V[v2];
+    V[V[v1].next].prev = n1;
+    V[V[v2].next].prev = n2;
+    V[v1].next = n2;
+    V[n2].prev = v1;
+    V[v2].next = n1;
+    V[n1].prev = v2;
+
+    // Edges (v, next) in the status now start at the copies
+    if( k1 != NONE )
+    {
+        S[k1].edge = n1;
+        V[v1].node = NONE;
+    }
+    if( k2 != NONE )
+    {
+        S[k2].edge = n2;
+        V[v2].node = NONE;
+    }
+}
+
+
+// -------------------------------------------------------- polygon_compare ---
+static int
+polygon_compare( const void * a, const void * b )
+{
+    const polygon_vertex_t * v1 = *(const polygon_vertex_t **) a;
+    const polygon_vertex_t * v2 = *(const polygon_vertex_t **) b;
+
+    if( v1->p.y > v2->p.y ) return -1;
+    if( v1->p.y < v2->p.y ) return +1;
+    if( v1->p.x > v2->p.x ) return -1;
+    if( v1->p.x < v2->p.x ) return +1;
+    return 0;
+}
+
+
+// ------------------------------------------------------ polygon_partition ---
+// Splits rings into y-monotone pieces (sweep from top to bottom adding
+// diagonals at split and merge vertices). Returns 0 on invalid input.
+static int
+polygon_partition( polygon_tessellator_t * self )
+{
+    size_t n = self->points->size;
+    size_t i, k, start = 0;
+    const size_t * rings = (const size_t *) self->rings->items;
+    const vec2 * P = (const vec2 *) self->points->items;
+    polygon_vertex_t * V;
+    polygon_vertex_t ** Q;
+    polygon_node_t * S;
+
+    // Every diagonal adds two vertices and there are less than n diagonals
+    vector_clear( self->vertices );
+    polygon_grow( self->vertices, 3*n );
+    vector_clear( self->queue );
+    polygon_grow( self->queue, n );
+    // Every vertex starts at most one status edge, after the header
+    vector_clear( self->status );
+    polygon_grow( self->status, 3*n + 1 );
+    S = (polygon_node_t *) self->status->items;
+    S[0].edge = S[0].left = S[0].right = S[0].parent = NONE;
+    S[0].priority = 0;
+    self->status->size = 1;
+    V = (polygon_vertex_t *) self->vertices->items;
+    Q = (polygon_vertex_t **) self->queue->items;
+
+    for( k=0; k<self->rings->size; ++k )
+    {
+        size_t count = rings[k];
+        for( i=start; i<start+count; ++i )
+        {
+            V[i].p = P[i];
+            V[i].id = i;
+            V[i].prev = (i == start) ? start+count-1 : i-1;
+            V[i].next = (i == start+count-1) ? start : i+1;
+            V[i].helper = i;
+            V[i].node = NONE;
+            V[i].used = 0;
+            Q[i] = &V[i];
+        }
+        start += count;
+    }
+    self->vertices->size = n;
+    self->queue->size = n;
+
+    for( i=0; i<n; ++i )
+    {
+        vec2 a = V[V[i].prev].p, b = V[i].p, c = V[V[i].next].p;
+        if( polygon_below( a, b ) && polygon_below( c, b ) )
+        {
+            V[i].type = polygon_convex( a, b, c ) ? start_vertex : split_vertex;
+        }
+        else if( polygon_below( b, a ) && polygon_below( b, c ) )
+        {
+            V[i].type = polygon_convex( a, b, c ) ? end_vertex : merge_vertex;
+        }
+        else
+        {
+            V[i].type = regular_vertex;
+        }
+    }
+    qsort( Q, n, sizeof(polygon_vertex_t *), polygon_compare );
+
+    for( i=0; i<n; ++i )
+    {
+        size_t v = Q[i] - V, e, h;
+
+        switch( V[v].type )
+        {
+        case start_vertex:
+            polygon_status_insert( self, v );
+            V[v].helper = v;
+            break;
+
+        case end_vertex:
+            e = V[v].prev;
+            if( V[e].node == NONE ) return 0;
+            if( V[V[e].helper].type == merge_vertex )
+            {
+                polygon_diagonal( self, v, V[e].helper );
+            }
+            polygon_status_erase( self, V[v].prev );
+            break;
+
+        case split_vertex:
+            k = polygon_status_left( self, V[v].p );
+            if( k == NONE ) return 0;
+            polygon_diagonal( self, v, V[S[k].edge].helper );
+            V[S[k].edge].helper = v;
+            h = self->vertices->size - 2;
+            polygon_status_insert( self, h );
+            V[h].helper = h;
+            break;
+
+        case merge_vertex:
+            e = V[v].prev;
+            if( V[e].node == NONE ) return 0;
+            h = v;
+            if( V[V[e].helper].type == merge_vertex )
+            {
+                polygon_diagonal( self, v, V[e].helper );
+                h = self->vertices->size - 2;
+            }
+            polygon_status_erase( self, V[v].prev );
+            k = polygon_status_left( self, V[v].p );
+            if( k == NONE ) return 0;
+            if( V[V[S[k].edge].helper].type == merge_vertex )
+            {
+                polygon_diagonal( self, h, V[S[k].edge].helper );
+            }
+            V[S[k].edge].helper = h;
+            break;
+
+        default:
+            if( polygon_below( V[v].p, V[V[v].prev].p ) )
+            {
+                // Interior is on the right of v
+                e = V[v].prev;
+                if( V[e].node == NONE ) return 0;
+                h = v;
+                if( V[V[e].helper].type == merge_vertex )
+                {
+                    polygon_diagonal( self, v, V[e].helper );
+                    h = self->vertices->size - 2;
+                }
+                polygon_status_erase( self, V[v].prev );
+                polygon_status_insert( self, h );
+                V[h].helper = h;
+            }
+            else
+            {
+                k = polygon_status_left( self, V[v].p );
+                if( k == NONE ) return 0;
+                if( V[V[S[k].edge].helper].type == merge_vertex )
+                {
+                    polygon_diagonal( self, v, V[S[k].edge].helper );
+                }
+                V[S[k].edge].helper = v;
+            }
+            break;
+        }
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------------- polygon_prepare ---
+// Copies rings without duplicate points, the outline counter-clockwise and
+// holes clockwise. Returns the number of points.
+static size_t
+polygon_prepare( polygon_tessellator_t * self,
+                 const vec2 * points,
+                 const size_t * counts,
+                 size_t n_rings )
+{
+    size_t r, i, offset = 0, total = 0;
+    vec2 * P;
+
+    for( r=0; r<n_rings; ++r )
+    {
+        total += counts[r];
+    }
+    vector_clear( self->points );
+    vector_clear( self->rings );
+    polygon_grow( self->points, total );
+    polygon_grow( self->rings, n_rings );
+    P = (vec2 *) self->points->items;
+
+    for( r=0; r<n_rings; ++r )
+    {
+        size_t start = self->points->size, n = start;
+        for( i=0; i<counts[r]; ++i )
+        {
+            vec2 Q = points[offset+i];
+            if( (n > start) &&
+                ((Q.x-P[n-1].x)*(Q.x-P[n-1].x) +
+                 (Q.y-P[n-1].y)*(Q.y-P[n-1].y) <= EPSILON) )
+            {
+                continue;
+            }
+            P[n++] = Q;
+        }
+        offset += counts[r];
+        while( (n > start+1) &&
+               ((P[n-1].x-P[start].x)*(P[n-1].x-P[start].x) +
+                (P[n-1].y-P[start].y)*(P[n-1].y-P[start].y) <= EPSILON) )
+        {
+            n--;
+        }
+
+        double area = 0;
+        for( i=start; i<n; ++i )
+        {
+            vec2 A = P[i], B = P[(i+1 < n) ? i+1 : start];
+            area += (double) A.x*B.y - (double) B.x*A.y;
+        }
+        if( (n < start+3) || (area == 0) )
+        {
+            if( r == 0 )
+            {
+                return 0;
+            }
+            continue;
+        }
+        if( (r == 0) != (area > 0) )
+        {
+            size_t a, b;
+            for( a=start, b=n-1; a<b; ++a, --b )
+            {
+                vec2 T = P[a]; P[a] = P[b]; P[b] = T;
+            }
+        }
+        self->points->size = n;
+        ((size_t *) self->rings->items)[self->rings->size++] = n - start;
+    }
+    return self->points->size;
+}
+
+
+// ---------------------------------------------------- polygon_triangulate ---
+size_t
+polygon_triangulate( polygon_tessellator_t * self,
+                     const vec2 * points,
+                     const size_t * counts,
+                     size_t n_rings )
+{
+    assert( self );
+    assert( points );
+    assert( counts );
+
+    size_t n = polygon_prepare( self, points, counts, n_rings );
+    size_t i, m;
+    size_t * scratch;
+
+    vector_clear( self->triangles );
+    if( n < 3 )
+    {
+        return 0;
+    }
+    polygon_grow( self->triangles, 3*(n + 2*self->rings->size) );
+    vector_clear( self->scratch );
+    polygon_grow( self->scratch, 4*3*n );
+    scratch = (size_t *) self->scratch->items;
+
+    if( (self->rings->size == 1) && (n <= EAR_CLIPPING_MAX) )
+    {
+        for( i=0; i<n; ++i )
+        {
+            scratch[i] = i;
+        }
+        polygon_ear_clip( self, scratch, n, scratch+n, scratch+2*n );
+        return self->triangles->size;
+    }
+
+    if( !polygon_partition( self ) )
+    {
+        // Invalid input (crossing rings), fill the outline only
+        size_t count = ((size_t *) self->rings->items)[0];
+        vector_clear( self->triangles );
+        for( i=0; i<count; ++i )
+        {
+            scratch[i] = i;
+        }
+        polygon_ear_clip( self, scratch, count, scratch+count, scratch+2*count );
+        return self->triangles->size;
+    }
+
+    // Triangulate every monotone piece
+    polygon_vertex_t * V = (polygon_vertex_t *) self->vertices->items;
+    size_t size = self->vertices->size;
+    for( i=0; i<size; ++i )
+    {
+        size_t v = i;
+        if( V[i].used )
+        {
+            continue;
+        }
+        for( m=0; !V[v].used && (m < size); ++m )
+        {
+            V[v].used = 1;
+            scratch[m] = V[v].id;
+            v = V[v].next;
+        }
+        if( m < 3 )
+        {
+            continue;
+        }
+        if( !polygon_monotone( self, scratch, m,
+                               scratch+m, scratch+2*m, scratch+3*m ) )
+        {
+            polygon_ear_clip( self, scratch, m, scratch+m, scratch+2*m );
+        }
+    }
+    return self->triangles->size;
+}
+
+
+// --------------------------------------------------------- polygon_fringe ---
+// Offset of a point toward the outer side of the fringe
+static vec2
+polygon_fringe( vec2 A, vec2 B, vec2 C )
+{
+    vec2 T0 = {{ B.x-A.x, B.y-A.y }}, T1 = {{ C.x-B.x, C.y-B.y }};
+    float l0 = hypot( T0.x, T0.y ), l1 = hypot( T1.x, T1.y );
+    vec2 N0 = {{ T0.y/l0, -T0.x/l0 }}, N1 = {{ T1.y/l1, -T1.x/l1 }};
+    vec2 M = {{ N0.x+N1.x, N0.y+N1.y }};
+    float l = hypot( M.x, M.y );
+
+    if( l < EPSILON )
+    {
+        M = N0;
+    }
+    else
+    {
+        M.x /= l;
+        M.y /= l;
+    }
+    float c = M.x*N0.x + M.y*N0.y;
+    float s = (FRINGE/2.0) / ((c > 1.0/FRINGE_MITER) ? c : 1.0/FRINGE_MITER);
+    return (vec2) {{ M.x*s, M.y*s }};
+}
+
+
+// ---------------------------------------------- vertex_buffer_add_polygon ---
+void
+vertex_buffer_add_polygon( vertex_buffer_t * self,
+                           polygon_tessellator_t * tessellator,
+                           const vec2 * points,
+                           const size_t * counts,
+                           size_t n_rings,
+                           vec4 color )
+{
+    assert( self );
+    assert( tessellator );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
+
+    size_t n_indices = polygon_triangulate( tessellator, points, counts, n_rings );
+    if( !n_indices )
+    {
+        return;
+    }
+    size_t n = tessellator->points->size;
+    size_t n_rings_ = tessellator->rings->size;
+    const vec2 * P = (const vec2 *) tessellator->points->items;
+    const size_t * rings = (const size_t *) tessellator->rings->items;
+    const GLuint * triangles = (const GLuint *) tessellator->triangles->items;
+    int strip = (self->primitive == GL_TRIANGLE_STRIP);
+    size_t vcount = 2*n, icount, i, j, r, start;
+    void * data;
+    GLuint * indices;
+
+    // Triangles, then one quad per edge of the fringe
+    if( strip )
+    {
+        icount = 4*(n_indices/3) + 2*n + 3*n_rings_;
+    }
+    else
+    {
+        icount = n_indices + 6*n;
+    }
+    GLuint base = vertex_buffer_reserve_item( self, vcount, icount,
+                                              &data, &indices );
+    vertex_t * vertices = (vertex_t *) data;
+
+    // Each point gives an inner vertex (fully covered) and an outer one
+    for( r=0, start=0; r<n_rings_; start += rings[r++] )
+    {
+        size_t count = rings[r];
+        for( j=0; j<count; ++j )
+        {
+            size_t a = start + (j+count-1)%count;
+            size_t b = start + j;
+            size_t c = start + (j+1)%count;
+            vec2 O = polygon_fringe( P[a], P[b], P[c] );
+            vertex_t inner = { P[b].x-O.x, P[b].y-O.y, 0,
+                               color.r, color.g, color.b, color.a, 0, 0, 0 };
+            vertex_t outer = { P[b].x+O.x, P[b].y+O.y, 0,
+                               color.r, color.g, color.b, color.a, 0, 1, 0 };
+            vertices[2*b+0] = inner;
+            vertices[2*b+1] = outer;
+        }
+    }
+
+    size_t k = 0;
+    for( i=0; i<n_indices; i+=3 )
+    {
+        indices[k++] = base + 2*triangles[i+0];
+        indices[k++] = base + 2*triangles[i+1];
+        indices[k++] = base + 2*triangles[i+2];
+        if( strip )
+        {
+            indices[k++] = VERTEX_BUFFER_RESTART_INDEX;
+        }
+    }
+    for( r=0, start=0; r<n_rings_; start += rings[r++] )
+    {
+        size_t count = rings[r];
+        for( j=0; j<count; ++j )
+        {
+            GLuint i0 = base + 2*(start + j);
+            GLuint i1 = base + 2*(start + (j+1)%count);
+            if( strip )
+            {
+                indices[k++] = i0;
+                indices[k++] = i0+1;
+            }
+            else
+            {
+                indices[k++] = i0;   indices[k++] = i0+1; indices[k++] = i1;
+                indices[k++] = i0+1; indices[k++] = i1;   indices[k++] = i1+1;
+            }
+        }
+        if( strip )
+        {
+            indices[k++] = base + 2*start;
+            indices[k++] = base + 2*start + 1;
+            indices[k++] = VERTEX_BUFFER_RESTART_INDEX;
+        }
+    }
+    assert( k == icount );
+    vertex_buffer_commit_item( self, vcount, icount );
+}
@@ -0,0 +1,161 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __POLYGON_H__
+#define __POLYGON_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   polygon.h
+ *
+ * @defgroup polygon Polygon
+ *
+ * Polygons (with holes) are filled with triangles obtained from a partition
+ * into y-monotone pieces (O(n log n)), small polygons without holes being
+ * ear clipped instead. Fill triangles are inset by half a pixel and
+ * surrounded by a one pixel wide anti-aliased fringe whose texture
+ * coordinates hold the distance to the inner side of the fringe. The third
+ * texture coordinate of fill vertices is 0 such that the "line-aa-round"
+ * fragment shader renders polylines and polygons alike. Vertex format is
+ * "v3f:c4f:t3f".
+ *
+ * The first ring of a polygon is its outline and the other ones are holes,
+ * whatever their orientation. Rings must not intersect each other nor
+ * themselves.
+ *
+ * All temporary storage is kept by the tessellator such that tessellating
+ * polygons every frame does not allocate memory once the high-water mark has
+ * been reached.
+ *
+ * Example Usage:
+ * @code
+ * polygon_tessellator_t * tessellator = polygon_tessellator_new( );
+ * vertex_buffer_add_polygon( buffer, tessellator, points, counts, 2, color );
+ * polygon_tessellator_delete( tessellator );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Polygon tessellator (temporary storage).
+ */
+typedef struct
+{
+    /** Points of the last polygon, duplicates removed and rings oriented. */
+    vector_t * points;
+
+    /** Number of points of each ring of the last polygon. */
+    vector_t * rings;
+
+    /** Vertices of the monotone partition. */
+    vector_t * vertices;
+
+    /** Vertices sorted from top to bottom. */
+    vector_t * queue;
+
+    /** Sweep line status (treap of the edges from left to right). */
+    vector_t * status;
+
+    /** Scratch storage of the triangulation of a single piece. */
+    vector_t * scratch;
+
+    /** Triangles of the last polygon (indices into points). */
+    vector_t * triangles;
+} polygon_tessellator_t;
+
+
+/**
+ * Creates a new polygon tessellator.
+ *
+ * @return  a new polygon tessellator
+ */
+  polygon_tessellator_t *
+  polygon_tessellator_new( void );
+
+
+/**
+ * Deletes a polygon tessellator.
+ *
+ * @param  self  a polygon tessellator
+ */
+  void
+  polygon_tessellator_delete( polygon_tessellator_t * self );
+
+
+/**
+ * Triangulates a polygon.
+ *
+ * Cleaned up points are stored into self->points, ring sizes into
+ * self->rings and triangles (indices into self->points) into
+ * self->triangles.
+ *
+ * @param  self     a polygon tessellator
+ * @param  points   points of all rings, one ring after the other
+ * @param  counts   number of points of each ring
+ * @param  n_rings  number of rings (outline first, then holes)
+ * @return          number of triangle indices
+ */
+  size_t
+  polygon_triangulate( polygon_tessellator_t * self,
+                       const vec2 * points,
+                       const size_t * counts,
+                       size_t n_rings );
+
+
+/**
+ * Add a filled anti-aliased polygon to a vertex buffer.
+ *
+ * @param  self         a vertex buffer with format "v3f:c4f:t3f"
+ * @param  tessellator  a polygon tessellator
+ * @param  points       points of all rings, one ring after the other
+ * @param  counts       number of points of each ring
+ * @param  n_rings      number of rings (outline first, then holes)
+ * @param  color        fill color
+ */
+  void
+  vertex_buffer_add_polygon( vertex_buffer_t * self,
+                             polygon_tessellator_t * tessellator,
+                             const vec2 * points,
+                             const size_t * counts,
+                             size_t n_rings,
+                             vec4 color );
+
+/** @} */
+
+#endif /* __POLYGON_H__ */
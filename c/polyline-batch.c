@@ -0,0 +1,304 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "polyline.h"
+#include "polyline-batch.h"
+
+
+#define max(a,b) ( (a)>(b) ? (a) : (b) )
+
+
+// --------------------------------------------------- typedefs and structs ---
+typedef struct
+{
+    polyline_batch_t      * batch;
+    vertex_buffer_t       * buffer;
+    const polyline_item_t * polylines;
+    size_t                  index;
+} polyline_job_t;
+
+
+// ----------------------------------------------------- polyline_batch_new ---
+polyline_batch_t *
+polyline_batch_new( size_t n_threads )
+{
+    assert( n_threads );
+
+    polyline_batch_t *self = (polyline_batch_t *) malloc( sizeof(polyline_batch_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->n_threads = n_threads;
+    self->workers = (polyline_worker_t *) calloc( n_threads, sizeof(polyline_worker_t) );
+    size_t i;
+    for( i=0; i<n_threads; ++i )
+    {
+        polyline_worker_t * worker = &self->workers[i];
+        worker->vertices = vector_new( 10*sizeof(float) );
+        worker->indices  = vector_new( sizeof(GLuint) );
+        worker->items    = vector_new( sizeof(ivec4) );
+    }
+    return self;
+}
+
+
+// -------------------------------------------------- polyline_batch_delete ---
+void
+polyline_batch_delete( polyline_batch_t * self )
+{
+    assert( self );
+
+    size_t i;
+    for( i=0; i<self->n_threads; ++i )
+    {
+        vector_delete( self->workers[i].vertices );
+        vector_delete( self->workers[i].indices );
+        vector_delete( self->workers[i].items );
+    }
+    free( self->workers );
+    free( self );
+}
+
+
+// ---------------------------------------------------- polyline_batch_grow ---
+static void
+polyline_batch_grow( vector_t * vector, size_t size )
+{
+    if( vector->capacity < size )
+    {
+        vector_reserve( vector, max( 2*vector->capacity, size ) );
+    }
+}
+
+
+// ------------------------------------------------ polyline_job_tessellate ---
+static void *
+polyline_job_tessellate( void * data )
+{
+    polyline_job_t * job = (polyline_job_t *) data;
+    polyline_worker_t * worker = &job->batch->workers[job->index];
+    const polyline_item_t * polylines = job->polylines;
+    size_t i, vcount, icount, vmax = 0, imax = 0;
+
+    vector_clear( worker->vertices );
+    vector_clear( worker->indices );
+    vector_clear( worker->items );
+    for( i=worker->first; i<worker->last; ++i )
+    {
+        polyline_bounds( polylines[i].n_points, polylines[i].closed,
+                         job->buffer->primitive, &vcount, &icount );
+        vmax += vcount;
+        imax += icount;
+    }
+    polyline_batch_grow( worker->vertices, vmax );
+    polyline_batch_grow( worker->indices, imax );
+    polyline_batch_grow( worker->items, worker->last - worker->first );
+
+    for( i=worker->first; i<worker->last; ++i )
+    {
+        const polyline_item_t * p = &polylines[i];
+        size_t vstart = worker->vertices->size;
+        size_t istart = worker->indices->size;
+        polyline_tessellate( p->points, p->n_points,
+                             p->color, p->thickness, p->join, p->cap,
+                             p->miter_limit, p->closed,
+                             job->buffer->primitive,
+                             (char *) worker->vertices->items
+                                 + vstart * worker->vertices->item_size,
+                             &vcount,
+                             (GLuint *) worker->indices->items + istart,
+                             &icount, vstart );
+        ivec4 item = {{ vstart, vcount, istart, icount }};
+        ((ivec4 *) worker->items->items)[worker->items->size++] = item;
+        worker->vertices->size += vcount;
+        worker->indices->size += icount;
+    }
+    return NULL;
+}
+
+
+// ---------------------------------------------------- polyline_job_merge ---
+static void *
+polyline_job_merge( void * data )
+{
+    polyline_job_t * job = (polyline_job_t *) data;
+    polyline_worker_t * worker = &job->batch->workers[job->index];
+    vertex_buffer_t * buffer = job->buffer;
+    size_t i;
+
+    memcpy( (char *) buffer->vertices->items
+                + worker->vbase * buffer->vertices->item_size,
+            worker->vertices->items,
+            worker->vertices->size * worker->vertices->item_size );
+
+    // A single offset rebases every index of this worker
+    GLuint base = worker->vbase;
+    const GLuint * src = (const GLuint *) worker->indices->items;
+    GLuint * dst = (GLuint *) buffer->indices->items + worker->ibase;
+    if( buffer->primitive == GL_TRIANGLE_STRIP )
+    {
+        for( i=0; i<worker->indices->size; ++i )
+        {
+            dst[i] = (src[i] == VERTEX_BUFFER_RESTART_INDEX)
+                   ? src[i] : src[i] + base;
+        }
+    }
+    else
+    {
+        for( i=0; i<worker->indices->size; ++i )
+        {
+            dst[i] = src[i] + base;
+        }
+    }
+
+    const ivec4 * items = (const ivec4 *) worker->items->items;
+    ivec4 * target = (ivec4 *) buffer->items->items + worker->pbase;
+    for( i=0; i<worker->items->size; ++i )
+    {
+        target[i] = items[i];
+        target[i].vstart += worker->vbase;
+        target[i].istart += worker->ibase;
+    }
+    return NULL;
+}
+
+
+// ------------------------------------------------------ polyline_batch_run ---
+// Run a job on every worker, the calling thread taking the first one
+static void
+polyline_batch_run( polyline_batch_t * self,
+                    polyline_job_t * jobs,
+                    void * (*function)(void *) )
+{
+    pthread_t threads[self->n_threads];
+    int started[self->n_threads];
+    size_t i;
+
+    for( i=1; i<self->n_threads; ++i )
+    {
+        started[i] = (pthread_create( &threads[i], NULL,
+                                      function, &jobs[i] ) == 0);
+        if( !started[i] )
+        {
+            (*function)( &jobs[i] );
+        }
+    }
+    (*function)( &jobs[0] );
+    for( i=1; i<self->n_threads; ++i )
+    {
+        if( started[i] )
+        {
+            pthread_join( threads[i], NULL );
+        }
+    }
+}
+
+
+// ---------------------------------------------- polyline_batch_tessellate ---
+void
+polyline_batch_tessellate( polyline_batch_t * self,
+                           vertex_buffer_t * buffer,
+                           const polyline_item_t * polylines,
+                           size_t count )
+{
+    assert( self );
+    assert( buffer );
+    assert( !buffer->vertex_chunks );
+    assert( vertex_buffer_format_id( buffer ) == VERTEX_FORMAT_V3F_C4F_T3F );
+
+    vertex_buffer_close_gap( buffer );
+    size_t n = self->n_threads;
+    size_t i, k, total = 0;
+    polyline_job_t jobs[n];
+
+    if( !count )
+    {
+        return;
+    }
+
+    // Split polylines into contiguous jobs of about the same number of points
+    for( i=0; i<count; ++i )
+    {
+        total += polylines[i].n_points;
+    }
+    size_t points = 0;
+    for( i=0, k=0; k<n; ++k )
+    {
+        polyline_worker_t * worker = &self->workers[k];
+        worker->first = i;
+        while( (i < count) &&
+               ((k == (n-1)) || (points*n < total*(k+1))) )
+        {
+            points += polylines[i].n_points;
+            ++i;
+        }
+        worker->last = i;
+        jobs[k] = (polyline_job_t) { self, buffer, polylines, k };
+    }
+
+    polyline_batch_run( self, jobs, polyline_job_tessellate );
+
+    // Exclusive prefix sum over workers counts
+    size_t vsize = buffer->vertices->size;
+    size_t isize = buffer->indices->size;
+    size_t psize = buffer->items->size;
+    size_t first = psize;
+    for( k=0; k<n; ++k )
+    {
+        polyline_worker_t * worker = &self->workers[k];
+        worker->vbase = vsize;
+        worker->ibase = isize;
+        worker->pbase = psize;
+        vsize += worker->vertices->size;
+        isize += worker->indices->size;
+        psize += worker->items->size;
+    }
+    vertex_buffer_unmap( buffer );
+    polyline_batch_grow( buffer->vertices, vsize );
+    polyline_batch_grow( buffer->indices, isize );
+    polyline_batch_grow( buffer->items, psize );
+    buffer->vertices->size = vsize;
+    buffer->indices->size = isize;
+    buffer->items->size = psize;
+    buffer->dirty = 1;
+
+    polyline_batch_run( self, jobs, polyline_job_merge );
+    vertex_buffer_track_items( buffer, first );
+}
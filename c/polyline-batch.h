@@ -0,0 +1,181 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __POLYLINE_BATCH_H__
+#define __POLYLINE_BATCH_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   polyline-batch.h
+ *
+ * @defgroup polyline-batch Polyline batch
+ *
+ * Parallel tessellation of many polylines at once. The batch is split into
+ * one job per worker thread, each worker tessellating its polylines into its
+ * own staging vertices and indices. Staging results are then merged into the
+ * target vertex buffer in parallel, each worker copying its vertices at an
+ * offset given by a prefix sum over the workers counts and rebasing its
+ * indices by that single offset.
+ *
+ * Staging storage is kept by the batch such that tessellating a new batch
+ * every frame does not reallocate memory once the high-water mark has been
+ * reached.
+ *
+ * Example Usage:
+ * @code
+ * polyline_batch_t * batch = polyline_batch_new( 4 );
+ * polyline_batch_tessellate( batch, buffer, polylines, count );
+ * polyline_batch_delete( batch );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Description of a single polyline of a batch.
+ */
+typedef struct
+{
+    /** Polyline points (not copied, must outlive the tessellation). */
+    const vec2 * points;
+
+    /** Number of points. */
+    size_t n_points;
+
+    /** Line color. */
+    vec4 color;
+
+    /** Line thickness. */
+    float thickness;
+
+    /** One of bevel_join, miter_join or round_join. */
+    int join;
+
+    /** One of square_cap, butt_cap or round_cap. */
+    int cap;
+
+    /** Maximum ratio of miter length to half thickness. */
+    float miter_limit;
+
+    /** Whether the last point connects to the first one. */
+    int closed;
+} polyline_item_t;
+
+
+/**
+ * Staging storage of a single worker.
+ */
+typedef struct
+{
+    /** Staging vertices ("v3f:c4f:t3f"). */
+    vector_t * vertices;
+
+    /** Staging indices, relative to the worker vertices. */
+    vector_t * indices;
+
+    /** Staging items, relative to the worker vertices and indices. */
+    vector_t * items;
+
+    /** First polyline handled by this worker. */
+    size_t first;
+
+    /** One past the last polyline handled by this worker. */
+    size_t last;
+
+    /** Offset of this worker vertices in the target buffer. */
+    size_t vbase;
+
+    /** Offset of this worker indices in the target buffer. */
+    size_t ibase;
+
+    /** Offset of this worker items in the target buffer. */
+    size_t pbase;
+} polyline_worker_t;
+
+
+/**
+ * Polyline batch tessellator.
+ */
+typedef struct
+{
+    /** Number of worker threads (including the calling one). */
+    size_t n_threads;
+
+    /** Per worker staging storage. */
+    polyline_worker_t * workers;
+} polyline_batch_t;
+
+
+/**
+ * Creates a new batch tessellator.
+ *
+ * @param  n_threads  number of threads (including the calling one)
+ * @return            a new batch tessellator
+ */
+  polyline_batch_t *
+  polyline_batch_new( size_t n_threads );
+
+
+/**
+ * Deletes a batch tessellator.
+ *
+ * @param  self  a batch tessellator
+ */
+  void
+  polyline_batch_delete( polyline_batch_t * self );
+
+
+/**
+ * Tessellate a batch of polylines and append them to a vertex buffer.
+ *
+ * Each polyline becomes a new item of the buffer, in batch order.
+ *
+ * @param  self       a batch tessellator
+ * @param  buffer     a vertex buffer with format "v3f:c4f:t3f"
+ * @param  polylines  polylines to be tessellated
+ * @param  count      number of polylines
+ */
+  void
+  polyline_batch_tessellate( polyline_batch_t * self,
+                             vertex_buffer_t * buffer,
+                             const polyline_item_t * polylines,
+                             size_t count );
+
+/** @} */
+
+#endif /* __POLYLINE_BATCH_H__ */
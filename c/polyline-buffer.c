@@ -0,0 +1,255 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "polyline.h"
+#include "polyline-buffer.h"
+
+
+// ---------------------------------------------------- polyline_buffer_new ---
+polyline_buffer_t *
+polyline_buffer_new( void )
+{
+    polyline_buffer_t *self = (polyline_buffer_t *) malloc( sizeof(polyline_buffer_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->points = vector_new( sizeof(vec2) );
+    self->paths  = vector_new( sizeof(ivec4) );
+    self->styles = vector_new( sizeof(vec4) );
+    self->points_id = 0;
+    self->paths_id  = 0;
+    self->styles_id = 0;
+    self->textures[0] = self->textures[1] = self->textures[2] = 0;
+    self->capacities[0] = self->capacities[1] = self->capacities[2] = 0;
+    self->dirty = 1;
+    self->paths_dirty = 1;
+    return self;
+}
+
+
+// ------------------------------------------------- polyline_buffer_delete ---
+void
+polyline_buffer_delete( polyline_buffer_t * self )
+{
+    assert( self );
+
+    vector_delete( self->points );
+    vector_delete( self->paths );
+    vector_delete( self->styles );
+    if( self->textures[0] )
+    {
+        glDeleteTextures( 3, self->textures );
+    }
+    if( self->points_id )
+    {
+        glDeleteBuffers( 1, &self->points_id );
+        glDeleteBuffers( 1, &self->paths_id );
+        glDeleteBuffers( 1, &self->styles_id );
+    }
+    free( self );
+}
+
+
+// --------------------------------------------------- polyline_buffer_size ---
+size_t
+polyline_buffer_size( const polyline_buffer_t * self )
+{
+    assert( self );
+
+    return vector_size( self->paths );
+}
+
+
+// -------------------------------------------------- polyline_buffer_clear ---
+void
+polyline_buffer_clear( polyline_buffer_t * self )
+{
+    assert( self );
+
+    vector_clear( self->points );
+    vector_clear( self->paths );
+    vector_clear( self->styles );
+    self->dirty = 1;
+    self->paths_dirty = 1;
+}
+
+
+// ------------------------------------------------- polyline_buffer_append ---
+size_t
+polyline_buffer_append( polyline_buffer_t * self,
+                        const vec2 * points, size_t n_points,
+                        vec4 color, float thickness,
+                        int join, int cap,
+                        float miter_limit, int closed )
+{
+    assert( self );
+    assert( points );
+    assert( n_points );
+
+    ivec4 path = {{ vector_size( self->points ), n_points,
+                    (join & 3) | ((cap & 3) << 2) | ((closed ? 1 : 0) << 4),
+                    0 }};
+    vec4 style = {{ thickness, miter_limit, 0, 0 }};
+
+    vector_push_back_data( self->points, points, n_points );
+    vector_push_back( self->paths, &path );
+    vector_push_back( self->styles, &color );
+    vector_push_back( self->styles, &style );
+    self->dirty = 1;
+    self->paths_dirty = 1;
+
+    return vector_size( self->paths ) - 1;
+}
+
+
+// --------------------------------------------- polyline_buffer_set_points ---
+void
+polyline_buffer_set_points( polyline_buffer_t * self,
+                            size_t index,
+                            const vec2 * points )
+{
+    assert( self );
+    assert( points );
+    assert( index < vector_size( self->paths ) );
+
+    ivec4 * path = (ivec4 *) vector_get( self->paths, index );
+    memcpy( vector_get( self->points, path->x ), points,
+            path->y * sizeof(vec2) );
+    self->dirty = 1;
+}
+
+
+// ----------------------------------------------- polyline_buffer_transfer ---
+// Upload a vector into a texture buffer, reusing its storage when it fits
+static void
+polyline_buffer_transfer( GLuint id, GLuint texture, GLenum format,
+                          vector_t * vector, size_t * capacity )
+{
+    glBindBuffer( GL_TEXTURE_BUFFER, id );
+    if( !*capacity || (vector->size > *capacity) )
+    {
+        glBufferData( GL_TEXTURE_BUFFER,
+                      vector->capacity * vector->item_size,
+                      NULL, GL_DYNAMIC_DRAW );
+        *capacity = vector->capacity;
+        glBindTexture( GL_TEXTURE_BUFFER, texture );
+        glTexBuffer( GL_TEXTURE_BUFFER, format, id );
+    }
+    if( vector->size )
+    {
+        glBufferSubData( GL_TEXTURE_BUFFER, 0,
+                         vector->size * vector->item_size, vector->items );
+    }
+}
+
+
+// ------------------------------------------------- polyline_buffer_upload ---
+void
+polyline_buffer_upload( polyline_buffer_t * self )
+{
+    assert( self );
+
+    if( !self->points_id )
+    {
+        glGenBuffers( 1, &self->points_id );
+        glGenBuffers( 1, &self->paths_id );
+        glGenBuffers( 1, &self->styles_id );
+        glGenTextures( 3, self->textures );
+    }
+    if( self->dirty )
+    {
+        polyline_buffer_transfer( self->points_id, self->textures[0],
+                                  GL_RG32F, self->points,
+                                  &self->capacities[0] );
+        self->dirty = 0;
+    }
+    if( self->paths_dirty )
+    {
+        polyline_buffer_transfer( self->paths_id, self->textures[1],
+                                  GL_RGBA32I, self->paths,
+                                  &self->capacities[1] );
+        polyline_buffer_transfer( self->styles_id, self->textures[2],
+                                  GL_RGBA32F, self->styles,
+                                  &self->capacities[2] );
+        self->paths_dirty = 0;
+    }
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+    glBindTexture( GL_TEXTURE_BUFFER, 0 );
+}
+
+
+// ------------------------------------------------- polyline_buffer_render ---
+void
+polyline_buffer_render( polyline_buffer_t * self,
+                        GLuint program )
+{
+    assert( self );
+
+    size_t i;
+    const char * samplers[3] = { "points", "paths", "styles" };
+
+    if( !vector_size( self->paths ) )
+    {
+        return;
+    }
+    if( self->dirty || self->paths_dirty )
+    {
+        polyline_buffer_upload( self );
+    }
+
+    glUseProgram( program );
+    for( i=0; i<3; ++i )
+    {
+        glActiveTexture( GL_TEXTURE0 + i );
+        glBindTexture( GL_TEXTURE_BUFFER, self->textures[i] );
+        glUniform1i( glGetUniformLocation( program, samplers[i] ), i );
+    }
+    glUniform1i( glGetUniformLocation( program, "n_paths" ),
+                 vector_size( self->paths ) );
+
+    // Six vertices (two triangles) per point, each point starting a segment
+    glDrawArrays( GL_TRIANGLES, 0, 6 * vector_size( self->points ) );
+
+    for( i=0; i<3; ++i )
+    {
+        glActiveTexture( GL_TEXTURE0 + i );
+        glBindTexture( GL_TEXTURE_BUFFER, 0 );
+    }
+    glActiveTexture( GL_TEXTURE0 );
+}
@@ -0,0 +1,201 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __POLYLINE_BUFFER_H__
+#define __POLYLINE_BUFFER_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   polyline-buffer.h
+ *
+ * @defgroup polyline-buffer Polyline buffer
+ *
+ * GPU side polyline expansion. Only raw points (8 bytes each) and per-path
+ * metadata are uploaded, into texture buffers. The "polyline.vert" shader
+ * pulls the previous, current and next points of each segment using
+ * gl_VertexID and builds a quad covering the segment and its joins. Caps
+ * and joins are then computed per fragment in "polyline.frag".
+ *
+ * Consecutive points of a path must be distinct, and closed paths must not
+ * repeat their first point.
+ *
+ * Example Usage:
+ * @code
+ * polyline_buffer_t * buffer = polyline_buffer_new( );
+ * GLuint program = shader_load( "shaders/polyline.vert",
+ *                               "shaders/polyline.frag" );
+ * polyline_buffer_append( buffer, points, n, color, 4.0,
+ *                         round_join, round_cap, 4.0, 0 );
+ * polyline_buffer_render( buffer, program );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Polyline buffer.
+ */
+typedef struct
+{
+    /** Points of all paths (vec2). */
+    vector_t * points;
+
+    /** Paths as (first point, number of points, flags, 0) (ivec4). */
+    vector_t * paths;
+
+    /** Path styles as color and (thickness, miter limit, 0, 0) (vec4). */
+    vector_t * styles;
+
+    /** GL identity of the points buffer. */
+    GLuint points_id;
+
+    /** GL identity of the paths buffer. */
+    GLuint paths_id;
+
+    /** GL identity of the styles buffer. */
+    GLuint styles_id;
+
+    /** GL identities of the points, paths and styles buffer textures. */
+    GLuint textures[3];
+
+    /** Number of points, paths and styles the GPU buffers can hold. */
+    size_t capacities[3];
+
+    /** Whether points need to be uploaded to GPU memory. */
+    char dirty;
+
+    /** Whether paths and styles need to be uploaded to GPU memory. */
+    char paths_dirty;
+} polyline_buffer_t;
+
+
+/**
+ * Creates an empty polyline buffer.
+ *
+ * @return  an empty polyline buffer
+ */
+  polyline_buffer_t *
+  polyline_buffer_new( void );
+
+
+/**
+ * Deletes a polyline buffer and releases GPU memory.
+ *
+ * @param  self  a polyline buffer
+ */
+  void
+  polyline_buffer_delete( polyline_buffer_t * self );
+
+
+/**
+ * Returns the number of paths.
+ *
+ * @param  self  a polyline buffer
+ * @return       number of paths
+ */
+  size_t
+  polyline_buffer_size( const polyline_buffer_t * self );
+
+
+/**
+ * Removes all paths.
+ *
+ * @param  self  a polyline buffer
+ */
+  void
+  polyline_buffer_clear( polyline_buffer_t * self );
+
+
+/**
+ * Append a path.
+ *
+ * @param  self         a polyline buffer
+ * @param  points       path points
+ * @param  n_points     number of points
+ * @param  color        line color
+ * @param  thickness    line thickness
+ * @param  join         one of bevel_join, miter_join or round_join
+ * @param  cap          one of square_cap, butt_cap or round_cap
+ * @param  miter_limit  maximum ratio of miter length to half thickness
+ * @param  closed       whether the last point connects to the first one
+ * @return              index of the new path
+ */
+  size_t
+  polyline_buffer_append( polyline_buffer_t * self,
+                          const vec2 * points, size_t n_points,
+                          vec4 color, float thickness,
+                          int join, int cap,
+                          float miter_limit, int closed );
+
+
+/**
+ * Replace the points of a path, keeping its number of points and style.
+ * Only points will be uploaded again.
+ *
+ * @param  self    a polyline buffer
+ * @param  index   index of the path
+ * @param  points  new path points
+ */
+  void
+  polyline_buffer_set_points( polyline_buffer_t * self,
+                              size_t index,
+                              const vec2 * points );
+
+
+/**
+ * Upload points and paths to GPU memory.
+ *
+ * @param  self  a polyline buffer
+ */
+  void
+  polyline_buffer_upload( polyline_buffer_t * self );
+
+
+/**
+ * Render all paths using the given "polyline" program.
+ *
+ * @param  self     a polyline buffer
+ * @param  program  a program linked from polyline.vert and polyline.frag
+ */
+  void
+  polyline_buffer_render( polyline_buffer_t * self,
+                          GLuint program );
+
+/** @} */
+
+#endif /* __POLYLINE_BUFFER_H__ */
@@ -0,0 +1,606 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include "polyline.h"
+
+
+// --------------------------------------------------- typedefs and structs ---
+typedef struct { float x,y,z,r,g,b,a,s,t,u; } vertex_t;
+
+// Tessellation state, living on the stack of polyline_tessellate
+typedef struct
+{
+    vertex_t * vertices;
+    size_t     vcount;
+    GLuint   * indices;
+    size_t     icount;
+    GLuint     base;
+    float      r, g, b, a;
+    float      w;  // half width of the geometry (pixels)
+    float      d;  // half width of the geometry (texture units)
+    float      t;  // thickness
+    int        join;
+    float      miter_limit;
+    GLenum     mode;
+} polyline_t;
+
+// Worst cases for a single join and a single cap
+#define JOIN_VERTICES 9
+#define JOIN_INDICES  15
+#define CAP_VERTICES  4
+#define CAP_INDICES   6
+
+// Same with GL_TRIANGLE_STRIP, each strip counting its restart index
+#define JOIN_STRIP_INDICES    11
+#define CAP_STRIP_INDICES     5
+#define SEGMENT_STRIP_INDICES 5
+
+#define EPSILON 1e-6
+
+
+// -------------------------------------------------------- polyline_vertex ---
+static GLuint
+polyline_vertex( polyline_t * self,
+                 vec2 P, float s, float t, float u )
+{
+    vertex_t * v = self->vertices + self->vcount;
+    v->x = P.x; v->y = P.y; v->z = 0;
+    v->r = self->r; v->g = self->g; v->b = self->b; v->a = self->a;
+    v->s = s; v->t = t; v->u = u;
+    return self->base + self->vcount++;
+}
+
+
+// --------------------------------------------------------- polyline_strip ---
+// Appends a triangle strip, continuing the previous one when it starts on the
+// last two emitted indices and separating it with a restart index otherwise.
+static void
+polyline_strip( polyline_t * self,
+                const GLuint * strip, size_t count )
+{
+    GLuint * i = self->indices;
+    size_t n = self->icount, k = 0;
+
+    if( (n >= 2) && (i[n-2] == strip[0]) && (i[n-1] == strip[1]) )
+    {
+        k = 2;
+    }
+    else if( n > 0 )
+    {
+        i[n++] = VERTEX_BUFFER_RESTART_INDEX;
+    }
+    for( ; k<count; ++k )
+    {
+        i[n++] = strip[k];
+    }
+    self->icount = n;
+}
+
+
+// ------------------------------------------------------ polyline_triangle ---
+static void
+polyline_triangle( polyline_t * self,
+                   GLuint i0, GLuint i1, GLuint i2 )
+{
+    if( self->mode == GL_TRIANGLE_STRIP )
+    {
+        GLuint strip[3] = { i0, i1, i2 };
+        polyline_strip( self, strip, 3 );
+        return;
+    }
+    GLuint * i = self->indices + self->icount;
+    i[0] = i0; i[1] = i1; i[2] = i2;
+    self->icount += 3;
+}
+
+
+// ---------------------------------------------------------- polyline_quad ---
+// Triangles (i0,i1,i2) and (i1,i2,i3)
+static void
+polyline_quad( polyline_t * self,
+               GLuint i0, GLuint i1, GLuint i2, GLuint i3 )
+{
+    if( self->mode == GL_TRIANGLE_STRIP )
+    {
+        GLuint strip[4] = { i0, i1, i2, i3 };
+        polyline_strip( self, strip, 4 );
+        return;
+    }
+    polyline_triangle( self, i0, i1, i2 );
+    polyline_triangle( self, i1, i2, i3 );
+}
+
+
+// ------------------------------------------------------- polyline_tangent ---
+static vec2
+polyline_tangent( vec2 P1, vec2 P2 )
+{
+    vec2 T = {{ P2.x - P1.x, P2.y - P1.y }};
+    float norm = sqrt( T.x*T.x + T.y*T.y );
+    if( norm > 0 )
+    {
+        T.x /= norm;
+        T.y /= norm;
+    }
+    return T;
+}
+
+
+// ---------------------------------------------------------- polyline_next ---
+// Index of the next point that is distinct from points[i] (or n if none)
+static size_t
+polyline_next( const vec2 * points, size_t n, size_t i )
+{
+    size_t j;
+    for( j=i+1; j<n; ++j )
+    {
+        float dx = points[j].x - points[i].x;
+        float dy = points[j].y - points[i].y;
+        if( (dx*dx + dy*dy) > EPSILON )
+        {
+            break;
+        }
+    }
+    return j;
+}
+
+
+// ------------------------------------------------------- polyline_segment ---
+static void
+polyline_segment( polyline_t * self,
+                  const GLuint start[2], const GLuint end[2] )
+{
+    polyline_quad( self, start[0], start[1], end[0], end[1] );
+}
+
+
+// ----------------------------------------------------------- polyline_cap ---
+/*
+ * P is the extremity, T the outward tangent and N the left normal of the
+ * segment the cap belongs to. x0 and x1 are the texture abscissa at P and at
+ * the outer side of the cap.
+ */
+static void
+polyline_cap( polyline_t * self,
+              vec2 P, vec2 T, vec2 N,
+              int cap, float x0, float x1 )
+{
+    float w = self->w, d = self->d;
+    float u = (cap == round_cap) ? self->t : -self->t;
+    float l = w;
+    if( cap == butt_cap )
+    {
+        // Only the anti-aliased fringe lies beyond the extremity
+        l = w * (d-1) / d;
+    }
+    vec2 Q = {{ P.x + T.x*l, P.y + T.y*l }};
+
+    GLuint i0 = polyline_vertex( self, (vec2) {{ P.x+N.x*w, P.y+N.y*w }}, x0, +d, u );
+    GLuint i1 = polyline_vertex( self, (vec2) {{ P.x-N.x*w, P.y-N.y*w }}, x0, -d, u );
+    GLuint i2 = polyline_vertex( self, (vec2) {{ Q.x+N.x*w, Q.y+N.y*w }}, x1, +d, u );
+    GLuint i3 = polyline_vertex( self, (vec2) {{ Q.x-N.x*w, Q.y-N.y*w }}, x1, -d, u );
+    polyline_quad( self, i0, i1, i2, i3 );
+}
+
+
+// ---------------------------------------------------------- polyline_join ---
+/*
+ *              I
+ *             / \
+ *            J   K        B:  joint
+ *           /  B  \       J:  outer side of AB at B
+ *          /   |   \      K:  outer side of BC at B
+ *         /    L    \     I:  outer miter point
+ *        /    / \    \    L:  inner miter point
+ *       A             C
+ *
+ * Writes the (left,right) vertex indices ending segment AB into end and the
+ * ones starting segment BC into start.
+ */
+static void
+polyline_join( polyline_t * self,
+               vec2 A, vec2 B, vec2 C,
+               GLuint end[2], GLuint start[2] )
+{
+    float w = self->w, d = self->d, t = self->t;
+    vec2 T0 = polyline_tangent( A, B );
+    vec2 T1 = polyline_tangent( B, C );
+    vec2 N0 = {{ -T0.y, T0.x }};
+    vec2 N1 = {{ -T1.y, T1.x }};
+    float cross = T0.x*T1.y - T0.y*T1.x;
+    float dot   = T0.x*T1.x + T0.y*T1.y;
+
+    // Straight continuation, segments share their vertices
+    if( (fabs(cross) < EPSILON) && (dot > 0) )
+    {
+        end[0] = start[0] = polyline_vertex(
+            self, (vec2) {{ B.x+N0.x*w, B.y+N0.y*w }}, 0, +d, t );
+        end[1] = start[1] = polyline_vertex(
+            self, (vec2) {{ B.x-N0.x*w, B.y-N0.y*w }}, 0, -d, t );
+        return;
+    }
+
+    // Outer side is on the right (-N) for a left turn
+    float so = (cross > 0) ? -1 : +1;
+    vec2 U0 = {{ so*N0.x, so*N0.y }};
+    vec2 U1 = {{ so*N1.x, so*N1.y }};
+    vec2 M  = polyline_tangent( T1, T0 );   // outer bisector
+    float c = M.x*U0.x + M.y*U0.y;          // cos of half turn angle
+    float ml = (c > EPSILON) ? w/c : 0;     // miter length
+
+    GLuint iB = polyline_vertex( self, B, 0, 0, t );
+    GLuint iJ = polyline_vertex( self, (vec2) {{ B.x+U0.x*w, B.y+U0.y*w }}, 0, so*d, t );
+    GLuint iK = polyline_vertex( self, (vec2) {{ B.x+U1.x*w, B.y+U1.y*w }}, 0, so*d, t );
+    GLuint iL0, iL1;
+
+    // Inner miter point is only usable if it falls within both segments
+    float lmin = fmin( hypot( B.x-A.x, B.y-A.y ), hypot( C.x-B.x, C.y-B.y ) );
+    if( (c > EPSILON) && (w*sqrt(1-c*c) <= c*lmin) )
+    {
+        iL0 = iL1 = polyline_vertex(
+            self, (vec2) {{ B.x-M.x*ml, B.y-M.y*ml }}, 0, -so*d, t );
+        polyline_quad( self, iJ, iB, iL0, iK );
+    }
+    else
+    {
+        // Segments overlap on the inner side
+        iL0 = polyline_vertex( self, (vec2) {{ B.x-U0.x*w, B.y-U0.y*w }}, 0, -so*d, t );
+        iL1 = polyline_vertex( self, (vec2) {{ B.x-U1.x*w, B.y-U1.y*w }}, 0, -so*d, t );
+    }
+
+    if( so > 0 )
+    {
+        end[0] = iJ;  end[1] = iL0;
+        start[0] = iK; start[1] = iL1;
+    }
+    else
+    {
+        end[0] = iL0;  end[1] = iJ;
+        start[0] = iL1; start[1] = iK;
+    }
+
+    if( (self->join == miter_join) && (c > EPSILON) &&
+        (ml <= self->miter_limit*w) )
+    {
+        GLuint iI = polyline_vertex(
+            self, (vec2) {{ B.x+M.x*ml, B.y+M.y*ml }}, 0, so*d, t );
+        polyline_quad( self, iJ, iB, iI, iK );
+    }
+    else if( self->join == round_join )
+    {
+        // Circle sector around B is enclosed in the tangent polygon J,P1,P2,K
+        // whose texture coordinates are B-centered (x<0 means radial distance)
+        vec2 Q0 = polyline_tangent( (vec2) {{ -U0.x, -U0.y }}, M );
+        vec2 Q1 = polyline_tangent( (vec2) {{ -M.x, -M.y }}, U1 );
+        float l = w / sqrt( (1+c)/2 );
+        vec2 P[4] = { {{ B.x+U0.x*w, B.y+U0.y*w }},
+                      {{ B.x+Q0.x*l, B.y+Q0.y*l }},
+                      {{ B.x+Q1.x*l, B.y+Q1.y*l }},
+                      {{ B.x+U1.x*w, B.y+U1.y*w }} };
+        GLuint iP[4];
+        size_t i;
+        for( i=0; i<4; ++i )
+        {
+            float dx = P[i].x - B.x, dy = P[i].y - B.y;
+            iP[i] = polyline_vertex( self, P[i],
+                                     -(dx*M.x + dy*M.y)/w*d,
+                                     (-dx*M.y + dy*M.x)/w*d, t );
+        }
+        if( self->mode == GL_TRIANGLE_STRIP )
+        {
+            GLuint strip[5] = { iP[0], iP[1], iB, iP[2], iP[3] };
+            polyline_strip( self, strip, 5 );
+        }
+        else
+        {
+            polyline_triangle( self, iB, iP[0], iP[1] );
+            polyline_triangle( self, iB, iP[1], iP[2] );
+            polyline_triangle( self, iB, iP[2], iP[3] );
+        }
+    }
+    else
+    {
+        // Bevel: distance is measured to the JK chord
+        GLuint iB_ = polyline_vertex( self, B, 0, so*d*(1-c), t );
+        polyline_triangle( self, iB_, iJ, iK );
+    }
+}
+
+
+// -------------------------------------------------------- polyline_bounds ---
+void
+polyline_bounds( size_t n_points, int closed, GLenum mode,
+                 size_t * vcount, size_t * icount )
+{
+    assert( vcount );
+    assert( icount );
+
+    if( (mode == GL_TRIANGLE_STRIP) && (n_points >= 2) )
+    {
+        polyline_bounds( n_points, closed, GL_TRIANGLES, vcount, icount );
+        if( closed && (n_points > 2) )
+        {
+            *icount = n_points * (JOIN_STRIP_INDICES + SEGMENT_STRIP_INDICES);
+        }
+        else
+        {
+            *icount = (n_points-1) * SEGMENT_STRIP_INDICES
+                    + (n_points-2) * JOIN_STRIP_INDICES
+                    + 2*CAP_STRIP_INDICES;
+        }
+    }
+    else if( closed && (n_points > 2) )
+    {
+        *vcount = n_points * JOIN_VERTICES;
+        *icount = n_points * (JOIN_INDICES + 6);
+    }
+    else if( n_points < 2 )
+    {
+        *vcount = 0;
+        *icount = 0;
+    }
+    else
+    {
+        *vcount = 4 + (n_points-2) * JOIN_VERTICES + 2*CAP_VERTICES;
+        *icount = 6*(n_points-1) + (n_points-2) * JOIN_INDICES + 2*CAP_INDICES;
+    }
+}
+
+
+// ---------------------------------------------------- polyline_tessellate ---
+void
+polyline_tessellate( const vec2 * points, size_t n_points,
+                     vec4 color, double thickness,
+                     int join, int cap,
+                     double miter_limit, int closed, GLenum mode,
+                     void * vertices, size_t * vcount,
+                     GLuint * indices, size_t * icount,
+                     GLuint base )
+{
+    assert( vcount );
+    assert( icount );
+
+    polyline_t self;
+    self.vertices = (vertex_t *) vertices;
+    self.vcount = 0;
+    self.indices = indices;
+    self.icount = 0;
+    self.base = base;
+    self.join = join;
+    self.miter_limit = miter_limit;
+    self.mode = mode;
+    self.t = thickness;
+    if( thickness < 1.0 )
+    {
+        self.w = 1.0;
+        self.d = 2.0;
+        color.a *= thickness;
+    }
+    else
+    {
+        self.w = (thickness+2.0)/2.0;
+        self.d = (thickness+2.0)/thickness;
+    }
+    self.r = color.r;
+    self.g = color.g;
+    self.b = color.b;
+    self.a = color.a;
+    *vcount = 0;
+    *icount = 0;
+
+    // Trailing points identical to the first one are implicit when closed
+    size_t n = n_points;
+    if( closed )
+    {
+        while( (n > 1) &&
+               (fabs( points[n-1].x - points[0].x ) < EPSILON) &&
+               (fabs( points[n-1].y - points[0].y ) < EPSILON) )
+        {
+            n--;
+        }
+        // A closed polyline needs at least three distinct points
+        size_t i1 = (n > 0) ? polyline_next( points, n, 0 ) : n;
+        if( (i1 >= n) || (polyline_next( points, n, i1 ) >= n) )
+        {
+            closed = 0;
+            n = n_points;
+        }
+    }
+    if( n < 2 )
+    {
+        return;
+    }
+
+    size_t i0 = 0, i1, i2;
+    GLuint first_end[2], first_start[2];
+    GLuint end[2], start[2], current[2];
+    vec2 A, B, C;
+
+    i1 = polyline_next( points, n, i0 );
+    if( i1 >= n )
+    {
+        return;
+    }
+
+    if( closed )
+    {
+        polyline_join( &self, points[n-1], points[0], points[i1],
+                       first_end, first_start );
+        current[0] = first_start[0];
+        current[1] = first_start[1];
+    }
+    else
+    {
+        vec2 T = polyline_tangent( points[i0], points[i1] );
+        vec2 N = {{ -T.y, T.x }};
+        A = points[i0];
+        polyline_cap( &self, A, (vec2) {{ -T.x, -T.y }}, N, cap,
+                      (cap == butt_cap) ? -1 : 0, -self.d );
+        current[0] = polyline_vertex(
+            &self, (vec2) {{ A.x+N.x*self.w, A.y+N.y*self.w }}, 0, +self.d, self.t );
+        current[1] = polyline_vertex(
+            &self, (vec2) {{ A.x-N.x*self.w, A.y-N.y*self.w }}, 0, -self.d, self.t );
+    }
+
+    A = points[i0];
+    B = points[i1];
+    while( 1 )
+    {
+        i2 = polyline_next( points, n, i1 );
+        if( i2 >= n )
+        {
+            if( closed )
+            {
+                polyline_join( &self, A, B, points[0], end, start );
+                polyline_segment( &self, current, end );
+                polyline_segment( &self, start, first_end );
+            }
+            else
+            {
+                vec2 T = polyline_tangent( A, B );
+                vec2 N = {{ -T.y, T.x }};
+                end[0] = polyline_vertex(
+                    &self, (vec2) {{ B.x+N.x*self.w, B.y+N.y*self.w }}, 0, +self.d, self.t );
+                end[1] = polyline_vertex(
+                    &self, (vec2) {{ B.x-N.x*self.w, B.y-N.y*self.w }}, 0, -self.d, self.t );
+                polyline_segment( &self, current, end );
+                polyline_cap( &self, B, T, N, cap,
+                              (cap == butt_cap) ? 2 : 1, 1+self.d );
+            }
+            break;
+        }
+        C = points[i2];
+        polyline_join( &self, A, B, C, end, start );
+        polyline_segment( &self, current, end );
+        current[0] = start[0];
+        current[1] = start[1];
+        A = B;
+        B = C;
+        i1 = i2;
+    }
+
+    // Terminate the last strip such that items can be drawn back to back
+    if( (mode == GL_TRIANGLE_STRIP) && self.icount )
+    {
+        self.indices[self.icount++] = VERTEX_BUFFER_RESTART_INDEX;
+    }
+
+    *vcount = self.vcount;
+    *icount = self.icount;
+}
+
+
+// --------------------------------------------- vertex_buffer_add_polyline ---
+void
+vertex_buffer_add_polyline( vertex_buffer_t * self,
+                            const vec2 * points, size_t n_points,
+                            vec4 color, double thickness,
+                            int join, int cap,
+                            double miter_limit, int closed )
+{
+    assert( self );
+    assert( points );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
+
+    size_t vcount, icount;
+    void * vertices;
+    GLuint * indices;
+
+    polyline_bounds( n_points, closed, self->primitive, &vcount, &icount );
+    if( !vcount )
+    {
+        return;
+    }
+    size_t vstart = vertex_buffer_reserve_item( self, vcount, icount,
+                                                &vertices, &indices );
+    polyline_tessellate( points, n_points, color, thickness,
+                         join, cap, miter_limit, closed, self->primitive,
+                         vertices, &vcount, indices, &icount, vstart );
+    vertex_buffer_commit_item( self, vcount, icount );
+}
+
+
+// ------------------------------------- vertex_buffer_add_polyline_clipped ---
+void
+vertex_buffer_add_polyline_clipped( vertex_buffer_t * self,
+                                    clipper_t * clipper,
+                                    const vec2 * points, size_t n_points,
+                                    vec4 color, double thickness,
+                                    int join, int cap,
+                                    double miter_limit, int closed )
+{
+    assert( self );
+    assert( clipper );
+    assert( points );
+    assert( vertex_buffer_format_id( self ) == VERTEX_FORMAT_V3F_C4F_T3F );
+
+    // Farthest any geometry goes from the polyline: miter joins, square
+    // caps (half thickness times sqrt 2) and the anti-aliased fringe
+    double w = (thickness < 1.0) ? 1.0 : thickness/2.0 + 1.0;
+    double padding = w * ((join == miter_join) ? fmax( miter_limit, 1.5 )
+                                               : 1.5);
+    size_t n_runs = clipper_polyline( clipper, points, n_points,
+                                      closed, padding );
+    const vec2 * P = (const vec2 *) clipper->points->items;
+    const size_t * runs = (const size_t *) clipper->runs->items;
+    size_t i, start, vcount = 0, icount = 0, vc, ic;
+    void * vertices;
+    GLuint * indices;
+
+    for( i=0; i<n_runs; ++i )
+    {
+        polyline_bounds( runs[i], clipper->closed, self->primitive, &vc, &ic );
+        vcount += vc;
+        icount += ic;
+    }
+    if( !vcount )
+    {
+        return;
+    }
+    size_t vstart = vertex_buffer_reserve_item( self, vcount, icount,
+                                                &vertices, &indices );
+    vcount = icount = 0;
+    for( i=0, start=0; i<n_runs; start += runs[i++] )
+    {
+        polyline_tessellate( P + start, runs[i], color, thickness,
+                             join, cap, miter_limit, clipper->closed,
+                             self->primitive,
+                             (vertex_t *) vertices + vcount, &vc,
+                             indices + icount, &ic, vstart + vcount );
+        vcount += vc;
+        icount += ic;
+    }
+    vertex_buffer_commit_item( self, vcount, icount );
+}
@@ -0,0 +1,179 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __POLYLINE_H__
+#define __POLYLINE_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vertex-buffer.h"
+#include "clip.h"
+
+
+/**
+ * @file   polyline.h
+ *
+ * @defgroup polyline Polyline
+ *
+ * Polylines are tessellated into anti-aliased triangles whose texture
+ * coordinates hold the (scaled) distance to the polyline such that the
+ * "line-aa-*" fragment shaders can compute coverage. Vertex format is
+ * "v3f:c4f:t3f".
+ *
+ * @{
+ */
+
+
+/**
+ * Line caps
+ */
+enum line_cap_e
+{
+    square_cap = 0,
+    butt_cap   = 1,
+    round_cap  = 2
+};
+
+
+/**
+ * Line joins
+ */
+enum line_join_e
+{
+    bevel_join = 0,
+    miter_join = 1,
+    round_join = 2
+};
+
+
+/**
+ *  Compute the maximum number of vertices and indices needed to tessellate
+ *  a polyline of n_points points.
+ *
+ *  @param  n_points  number of points
+ *  @param  closed    whether the polyline is closed
+ *  @param  mode      GL_TRIANGLES or GL_TRIANGLE_STRIP
+ *  @param  vcount    maximum number of vertices (out)
+ *  @param  icount    maximum number of indices (out)
+ */
+  void
+  polyline_bounds( size_t n_points, int closed, GLenum mode,
+                   size_t * vcount, size_t * icount );
+
+
+/**
+ *  Tessellate a polyline into user provided storage.
+ *
+ *  Vertices and indices must have room for at least the amount given by
+ *  polyline_bounds. Nothing is allocated.
+ *
+ *  @param  points       polyline points
+ *  @param  n_points     number of points
+ *  @param  color        line color
+ *  @param  thickness    line thickness
+ *  @param  join         one of bevel_join, miter_join or round_join
+ *  @param  cap          one of square_cap, butt_cap or round_cap
+ *  @param  miter_limit  maximum ratio of miter length to half thickness
+ *                       before a miter join falls back to a bevel join
+ *  @param  closed       whether the last point connects to the first one
+ *  @param  mode         GL_TRIANGLES, or GL_TRIANGLE_STRIP for strips
+ *                       separated and terminated by
+ *                       VERTEX_BUFFER_RESTART_INDEX (never rebased)
+ *  @param  vertices     "v3f:c4f:t3f" vertices to be written
+ *  @param  vcount       number of vertices written (out)
+ *  @param  indices      indices to be written
+ *  @param  icount       number of indices written (out)
+ *  @param  base         offset added to every written index
+ */
+  void
+  polyline_tessellate( const vec2 * points, size_t n_points,
+                       vec4 color, double thickness,
+                       int join, int cap,
+                       double miter_limit, int closed, GLenum mode,
+                       void * vertices, size_t * vcount,
+                       GLuint * indices, size_t * icount,
+                       GLuint base );
+
+
+/**
+ *  Add a polyline to a vertex buffer
+ *
+ *  The polyline is tessellated directly into the buffer storage.
+ *
+ *  @param  self         a vertex buffer with format "v3f:c4f:t3f"
+ *  @param  points       polyline points
+ *  @param  n_points     number of points
+ *  @param  color        line color
+ *  @param  thickness    line thickness
+ *  @param  join         one of bevel_join, miter_join or round_join
+ *  @param  cap          one of square_cap, butt_cap or round_cap
+ *  @param  miter_limit  maximum ratio of miter length to half thickness
+ *  @param  closed       whether the last point connects to the first one
+ */
+  void
+  vertex_buffer_add_polyline( vertex_buffer_t * self,
+                              const vec2 * points, size_t n_points,
+                              vec4 color, double thickness,
+                              int join, int cap,
+                              double miter_limit, int closed );
+
+
+/**
+ *  Add the visible part of a polyline to a vertex buffer
+ *
+ *  The polyline is clipped against the viewport of the clipper, padded by
+ *  the extent of the joins and caps, before being tessellated such that
+ *  only its visible runs are tessellated (see clip.h). The runs make a
+ *  single item.
+ *
+ *  @param  self         a vertex buffer with format "v3f:c4f:t3f"
+ *  @param  clipper      a clipper
+ *  @param  points       polyline points
+ *  @param  n_points     number of points
+ *  @param  color        line color
+ *  @param  thickness    line thickness
+ *  @param  join         one of bevel_join, miter_join or round_join
+ *  @param  cap          one of square_cap, butt_cap or round_cap
+ *  @param  miter_limit  maximum ratio of miter length to half thickness
+ *  @param  closed       whether the last point connects to the first one
+ */
+  void
+  vertex_buffer_add_polyline_clipped( vertex_buffer_t * self,
+                                      clipper_t * clipper,
+                                      const vec2 * points, size_t n_points,
+                                      vec4 color, double thickness,
+                                      int join, int cap,
+                                      double miter_limit, int closed );
+
+/** @} */
+
+#endif /* __POLYLINE_H__ */
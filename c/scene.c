@@ -0,0 +1,255 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <time.h>
+#include "scene.h"
+
+
+// The handoff flag is only set by the producer and only cleared by the
+// rendering thread, compare-and-swap also acting as a full memory barrier
+#if defined(__GNUC__)
+    #define SCENE_ATOMIC_SET( flag, from, to ) \
+        __sync_bool_compare_and_swap( &(flag), (from), (to) )
+    #define SCENE_BARRIER( ) __sync_synchronize( )
+#else
+    #define SCENE_ATOMIC_SET( flag, from, to ) ((flag) = (to))
+    #define SCENE_BARRIER( )
+#endif
+
+// Number of yields before a waiting thread starts sleeping
+#define SCENE_SPINS 16
+
+// Sleep (in nanoseconds) of a waiting thread once done spinning
+#define SCENE_SLEEP 100000
+
+
+// ---------------------------------------------------------- scene_backoff ---
+// Waiting threads yield first, then sleep such that they do not take CPU
+// time from the other thread when both share a core
+static void
+scene_backoff( size_t * spins )
+{
+    if( (*spins)++ < SCENE_SPINS )
+    {
+        sched_yield( );
+    }
+    else
+    {
+        struct timespec delay = { 0, SCENE_SLEEP };
+        nanosleep( &delay, NULL );
+    }
+}
+
+
+// -------------------------------------------------------------- scene_new ---
+scene_t *
+scene_new( const char * format,
+           size_t n_buffers )
+{
+    assert( format );
+    assert( n_buffers );
+
+    size_t i, j;
+    scene_t * self = (scene_t *) malloc( sizeof(scene_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->n_buffers = n_buffers;
+    for( i=0; i<2; ++i )
+    {
+        self->buffers[i] = (vertex_buffer_t **)
+            malloc( n_buffers * sizeof(vertex_buffer_t *) );
+        if( !self->buffers[i] )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n",
+                     __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        for( j=0; j<n_buffers; ++j )
+        {
+            self->buffers[i][j] = vertex_buffer_new( format );
+        }
+    }
+    self->front = 0;
+    self->ready = 0;
+    self->quit = 0;
+    self->started = 0;
+    self->produce = 0;
+    self->data = 0;
+    self->frame = (size_t) -1;
+    self->produced = 0;
+    return self;
+}
+
+
+// ----------------------------------------------------------- scene_delete ---
+void
+scene_delete( scene_t * self )
+{
+    size_t i, j;
+
+    assert( self );
+
+    self->quit = 1;
+    SCENE_BARRIER( );
+    if( self->started )
+    {
+        pthread_join( self->thread, NULL );
+    }
+    for( i=0; i<2; ++i )
+    {
+        for( j=0; j<self->n_buffers; ++j )
+        {
+            vertex_buffer_delete( self->buffers[i][j] );
+        }
+        free( self->buffers[i] );
+    }
+    free( self );
+}
+
+
+// ---------------------------------------------------- scene_set_primitive ---
+void
+scene_set_primitive( scene_t * self,
+                     size_t index,
+                     GLenum primitive )
+{
+    assert( self );
+    assert( !self->started );
+    assert( index < self->n_buffers );
+
+    vertex_buffer_set_primitive( self->buffers[0][index], primitive );
+    vertex_buffer_set_primitive( self->buffers[1][index], primitive );
+}
+
+
+// --------------------------------------------------------- scene_producer ---
+static void *
+scene_producer( void * data )
+{
+    scene_t * self = (scene_t *) data;
+    size_t i, spins;
+
+    while( !self->quit )
+    {
+        // The front index cannot change while the back set is not ready
+        vertex_buffer_t ** back = self->buffers[1 - self->front];
+        for( i=0; i<self->n_buffers; ++i )
+        {
+            vertex_buffer_clear( back[i] );
+        }
+        (*self->produce)( back, self->produced, self->data );
+        self->produced++;
+        SCENE_ATOMIC_SET( self->ready, 0, 1 );
+
+        // Wait for the rendering thread to take the frame
+        spins = 0;
+        while( self->ready && !self->quit )
+        {
+            scene_backoff( &spins );
+        }
+
+        // Acquire the front index written before ready was cleared
+        SCENE_BARRIER( );
+    }
+    return NULL;
+}
+
+
+// ------------------------------------------------------------ scene_start ---
+void
+scene_start( scene_t * self,
+             scene_produce_t produce,
+             void * data )
+{
+    assert( self );
+    assert( produce );
+    assert( !self->started );
+
+    self->produce = produce;
+    self->data = data;
+    if( pthread_create( &self->thread, NULL, scene_producer, self ) )
+    {
+        fprintf( stderr,
+                 "line %d: Unable to start producer thread\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->started = 1;
+}
+
+
+// ------------------------------------------------------------- scene_swap ---
+int
+scene_swap( scene_t * self,
+            int wait )
+{
+    size_t spins = 0;
+
+    assert( self );
+
+    while( !self->ready )
+    {
+        if( !wait || !self->started || self->quit )
+        {
+            return 0;
+        }
+        scene_backoff( &spins );
+    }
+    SCENE_BARRIER( );
+
+    // Flipped sets are fully uploaded when next rendered since clearing
+    // a buffer marks it dirty
+    self->front = 1 - self->front;
+    self->frame = self->produced - 1;
+    SCENE_ATOMIC_SET( self->ready, 1, 0 );
+    return 1;
+}
+
+
+// ------------------------------------------------------------ scene_front ---
+vertex_buffer_t *
+scene_front( const scene_t * self,
+             size_t index )
+{
+    assert( self );
+    assert( index < self->n_buffers );
+
+    return self->buffers[self->front][index];
+}
@@ -0,0 +1,209 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __SCENE_H__
+#define __SCENE_H__
+#include <stddef.h>
+#include <pthread.h>
+
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   scene.h
+ *
+ * @defgroup scene Scene
+ *
+ * Double-buffered scene. A scene holds two sets of vertex buffers: the
+ * front set is uploaded and rendered by the rendering thread while a
+ * producer thread tessellates the next frame into the back set. Once the
+ * back set is complete, the producer publishes it and waits; the rendering
+ * thread picks it up when it starts its next frame by flipping the sets and
+ * handing the previous front set back to the producer.
+ *
+ * The handoff is a single flag set by the producer and cleared by the
+ * rendering thread with atomic operations, such that neither thread ever
+ * takes a lock. Tessellation and rendering thus overlap and a frame costs
+ * the maximum of both instead of their sum.
+ *
+ * Only the producer thread touches the back set and only the rendering
+ * thread touches the front set (and GL).
+ *
+ * Example Usage:
+ * @code
+ * void produce( vertex_buffer_t ** buffers, size_t frame, void * data )
+ * {
+ *     vertex_buffer_add_circle( buffers[0], ... );
+ * }
+ *
+ * scene_t * scene = scene_new( "v3f:c4f:t3f", 1 );
+ * scene_start( scene, produce, data );
+ *
+ * // every frame (display callback)
+ * scene_swap( scene, 1 );
+ * vertex_buffer_render( scene_front( scene, 0 ), GL_TRIANGLES, "vct" );
+ *
+ * scene_delete( scene );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Tessellates a frame into the (cleared) back buffers of a scene.
+ *
+ * @param  buffers  back buffers of the scene
+ * @param  frame    frame number, starting at 0
+ * @param  data     user data given to scene_start
+ */
+typedef void (*scene_produce_t)( vertex_buffer_t ** buffers,
+                                 size_t frame,
+                                 void * data );
+
+
+/**
+ * Double-buffered scene.
+ */
+typedef struct
+{
+    /** Number of buffers per set. */
+    size_t n_buffers;
+
+    /** Front and back buffer sets. */
+    vertex_buffer_t ** buffers[2];
+
+    /** Index of the front set. */
+    volatile int front;
+
+    /** Whether the back set holds a complete frame. */
+    volatile int ready;
+
+    /** Whether the producer has to stop. */
+    volatile int quit;
+
+    /** Producer thread. */
+    pthread_t thread;
+
+    /** Whether the producer thread has been started. */
+    int started;
+
+    /** Tessellation function. */
+    scene_produce_t produce;
+
+    /** User data given to the tessellation function. */
+    void * data;
+
+    /** Number of the frame in the front set (-1 before the first one). */
+    size_t frame;
+
+    /** Number of frames produced so far. */
+    volatile size_t produced;
+} scene_t;
+
+
+/**
+ * Creates a scene with n_buffers buffers per set.
+ *
+ * @param  format     format of the buffers (see vertex_buffer_new)
+ * @param  n_buffers  number of buffers per set
+ * @return            a new scene
+ */
+  scene_t *
+  scene_new( const char * format,
+             size_t n_buffers );
+
+
+/**
+ * Stops the producer thread and deletes the scene and its buffers.
+ *
+ * @param  self  a scene
+ */
+  void
+  scene_delete( scene_t * self );
+
+
+/**
+ * Sets the primitive of a buffer in both sets. The scene must not be
+ * started.
+ *
+ * @param  self       a scene
+ * @param  index      buffer index
+ * @param  primitive  GL_TRIANGLES, GL_TRIANGLE_STRIP or GL_QUADS
+ */
+  void
+  scene_set_primitive( scene_t * self,
+                       size_t index,
+                       GLenum primitive );
+
+
+/**
+ * Starts the producer thread, which clears the back buffers and calls
+ * produce for every frame until the scene is deleted.
+ *
+ * @param  self     a scene
+ * @param  produce  tessellation function
+ * @param  data     user data given to produce
+ */
+  void
+  scene_start( scene_t * self,
+               scene_produce_t produce,
+               void * data );
+
+
+/**
+ * Makes the last produced frame the front one, if any. To be called from
+ * the rendering thread before rendering a frame.
+ *
+ * @param  self  a scene
+ * @param  wait  whether to wait for a new frame when none is ready
+ * @return       1 if the front set has changed, 0 otherwise
+ */
+  int
+  scene_swap( scene_t * self,
+              int wait );
+
+
+/**
+ * Returns a buffer of the front set.
+ *
+ * @param  self   a scene
+ * @param  index  buffer index
+ * @return        a vertex buffer
+ */
+  vertex_buffer_t *
+  scene_front( const scene_t * self,
+               size_t index );
+
+/** @} */
+
+#endif /* __SCENE_H__ */
@@ -36,6 +36,12 @@ void main(void)
     vec3  p = gl_TexCoord[0].xyz;
     float dist;
 
+    if( p.z == 0.0 ) // polygon fill, p.y is the distance to the inner fringe
+    {
+        gl_FragColor = vec4(color.rgb, color.a*clamp(1.0-p.y, 0.0, 1.0));
+        return;
+    }
+
     if( p.z < 0.0 )
     {
         float xdist = min(abs(p.x),abs(p.x-1.0));
@@ -0,0 +1,83 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http:* code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+#version 150 compatibility
+
+in vec2      v_position;
+flat in vec4 v_color;
+flat in vec3 v_segment;
+flat in vec4 v_start;
+flat in vec4 v_end;
+
+// Distance to the polyline of a point p expressed in an extremity frame (x
+// pointing inside the segment), or a negative value if p belongs to the
+// neighbor segment.
+float extremity( vec2 p, vec4 e, float hw, float limit )
+{
+    int type = int( e.z );
+    if( type < 3 )
+    {
+        if( p.x >= 0.0 ) return abs( p.y );
+        if( type == 0 )  return max( abs( p.y ), -p.x );
+        if( type == 1 )  return max( abs( p.y ), hw - p.x );
+        return length( p );
+    }
+
+    // Segments are split along the bisector of the join
+    vec2 u = e.xy;
+    vec2 b = vec2( 1.0, 0.0 ) - u;
+    if( (length( b ) > 1e-5) && (dot( p, b ) < 0.0) ) return -1.0;
+    if( p.x >= 0.0 ) return abs( p.y );
+
+    float so = (u.y > 0.0) ? -1.0 : 1.0;
+    if( p.y*so <= 0.0 ) return abs( p.y );
+    if( type == 5 )     return length( p );
+
+    float c = e.w;
+    if( (type == 4) && (c*limit >= 1.0) ) return abs( p.y );
+    vec2 mo = -normalize( u + vec2( 1.0, 0.0 ) );
+    return max( abs( p.y ), dot( p, mo ) + hw*(1.0 - c) );
+}
+
+void main( void )
+{
+    float L = v_segment.x, hw = v_segment.y, limit = v_segment.z;
+    vec2 p = v_position;
+
+    float d0 = extremity( p, v_start, hw, limit );
+    float d1 = extremity( vec2( L - p.x, -p.y ), v_end, hw, limit );
+    if( (d0 < 0.0) || (d1 < 0.0) )
+        discard;
+    float dist = max( d0, d1 );
+    float width = fwidth( dist );
+    float alpha = smoothstep( hw+width, hw-width, dist );
+    gl_FragColor = vec4( v_color.rgb, v_color.a*alpha );
+}
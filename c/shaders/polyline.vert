@@ -0,0 +1,151 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http:* code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+#version 150 compatibility
+
+// Points (xy), paths (first, count, flags, -) and styles (color followed by
+// thickness and miter limit) as uploaded by polyline-buffer.c
+uniform samplerBuffer  points;
+uniform isamplerBuffer paths;
+uniform samplerBuffer  styles;
+uniform int            n_paths;
+
+out vec2      v_position;  // position in the segment frame
+flat out vec4 v_color;
+flat out vec3 v_segment;   // length, half thickness, miter limit
+flat out vec4 v_start;     // neighbor direction (segment frame), type, cos
+flat out vec4 v_end;       // same as v_start, in the end frame
+
+const int corners[6] = int[6]( 0, 1, 2, 0, 2, 3 );
+
+// Path owning the given point (binary search over path first points)
+int find_path( int index )
+{
+    int lo = 0, hi = n_paths-1;
+    while( lo < hi )
+    {
+        int mid = (lo+hi+1)/2;
+        if( texelFetch( paths, mid ).x <= index ) lo = mid;
+        else                                      hi = mid-1;
+    }
+    return lo;
+}
+
+// Describe a segment extremity, u being the direction of the neighbor
+// segment (in the extremity frame, x pointing inside the segment). Type is
+// the cap (0,1,2) or 3 + join (3,4,5). Returns how far the geometry must
+// extend beyond the extremity.
+float extremity( inout vec4 e, vec2 u, int type, float hw, float limit )
+{
+    e = vec4( u, float(type), 0.0 );
+    if( type == 1 )
+        return 1.0;
+    if( type < 3 )
+        return hw + 1.0;
+    vec2 b = u + vec2( 1.0, 0.0 );
+    if( length( b ) < 1e-5 )
+        return 1.0;
+    vec2 mo = -normalize( b );
+    float so = (u.y > 0.0) ? -1.0 : 1.0;
+    e.w = mo.y * so;
+    if( (type == 4) && (e.w*limit >= 1.0) )
+        return hw*sqrt( 1.0 - e.w*e.w )/e.w + 1.0;
+    return hw + 1.0;
+}
+
+void main( void )
+{
+    int segment = gl_VertexID / 6;
+    int corner  = corners[gl_VertexID % 6];
+    int path    = find_path( segment );
+    ivec4 info  = texelFetch( paths, path );
+    int first = info.x, count = info.y, flags = info.z;
+    int join = flags & 3, cap = (flags >> 2) & 3;
+    bool closed = (flags & 16) != 0;
+    int k = segment - first;
+
+    // Last point of an open path does not start any segment
+    if( (count < 2) || ((k == count-1) && !closed) )
+    {
+        gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );
+        return;
+    }
+
+    vec4 color = texelFetch( styles, 2*path );
+    vec4 style = texelFetch( styles, 2*path+1 );
+    float thickness = style.x;
+    if( thickness < 1.0 )
+    {
+        color.a *= thickness;
+        thickness = 1.0;
+    }
+    float hw = thickness/2.0;
+
+    vec2 P0 = texelFetch( points, segment ).xy;
+    vec2 P1 = texelFetch( points, first + (k+1) % count ).xy;
+    vec2 T = P1 - P0;
+    float L = length( T );
+    T /= L;
+    vec2 N = vec2( -T.y, T.x );
+
+    float ext0, ext1;
+    if( (k > 0) || closed )
+    {
+        vec2 P = texelFetch( points, first + (k+count-1) % count ).xy;
+        vec2 u = normalize( P - P0 );
+        ext0 = extremity( v_start, vec2( dot(u,T), dot(u,N) ),
+                          3+join, hw, style.y );
+    }
+    else
+    {
+        ext0 = extremity( v_start, vec2( 0.0 ), cap, hw, style.y );
+    }
+    if( (k+2 < count) || closed )
+    {
+        vec2 P = texelFetch( points, first + (k+2) % count ).xy;
+        vec2 u = normalize( P - P1 );
+        ext1 = extremity( v_end, vec2( -dot(u,T), -dot(u,N) ),
+                          3+join, hw, style.y );
+    }
+    else
+    {
+        ext1 = extremity( v_end, vec2( 0.0 ), cap, hw, style.y );
+    }
+
+    float x = (corner < 2) ? -ext0 : L + ext1;
+    float y = ((corner == 1) || (corner == 2)) ? hw + 1.0 : -hw - 1.0;
+    vec2 P = P0 + T*x + N*y;
+
+    v_position = vec2( x, y );
+    v_color = color;
+    v_segment = vec3( L, hw, style.y );
+    gl_Position = gl_ModelViewProjectionMatrix * vec4( P, 0.0, 1.0 );
+}
@@ -0,0 +1,676 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include "spatial-index.h"
+
+
+// --------------------------------------------------- typedefs and structs ---
+// Cell of the hash table (x == CELL_EMPTY for an empty slot).
+typedef struct
+{
+    int x, y;
+    size_t head;
+} spatial_cell_t;
+
+// Registration of a box into a cell.
+typedef struct
+{
+    size_t item;
+    size_t next;
+} spatial_entry_t;
+
+#define max(a,b)   ( (a)>(b) ? (a) : (b) )
+#define NONE       ((size_t) -1)
+#define CELL_EMPTY INT_MIN
+
+// Boxes overlapping more cells than this are large boxes
+#define MAX_CELLS 64
+
+// Initial number of slots of the hash table (a power of two)
+#define MIN_SLOTS 64
+
+
+// ------------------------------------------------------ spatial_index_new ---
+spatial_index_t *
+spatial_index_new( float cell_size )
+{
+    assert( cell_size > 0 );
+
+    spatial_index_t *self =
+        (spatial_index_t *) malloc( sizeof(spatial_index_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->cell_size = cell_size;
+    self->cells   = vector_new( sizeof(spatial_cell_t) );
+    self->entries = vector_new( sizeof(spatial_entry_t) );
+    self->large   = vector_new( sizeof(size_t) );
+    self->bounds  = vector_new( sizeof(vec4) );
+    self->stamps  = vector_new( sizeof(unsigned int) );
+    spatial_index_clear( self );
+    return self;
+}
+
+
+// --------------------------------------------------- spatial_index_delete ---
+void
+spatial_index_delete( spatial_index_t * self )
+{
+    assert( self );
+
+    vector_delete( self->cells );
+    vector_delete( self->entries );
+    vector_delete( self->large );
+    vector_delete( self->bounds );
+    vector_delete( self->stamps );
+    free( self );
+}
+
+
+// ---------------------------------------------------- spatial_index_slots ---
+// Empties the hash table and sets its number of slots.
+void
+spatial_index_slots( spatial_index_t * self, size_t n )
+{
+    spatial_cell_t empty = { CELL_EMPTY, CELL_EMPTY, NONE };
+    size_t i;
+
+    vector_clear( self->cells );
+    vector_reserve( self->cells, n );
+    for( i=0; i<n; ++i )
+    {
+        vector_push_back( self->cells, &empty );
+    }
+    self->n_cells = 0;
+}
+
+
+// ---------------------------------------------------- spatial_index_clear ---
+void
+spatial_index_clear( spatial_index_t * self )
+{
+    assert( self );
+
+    spatial_index_slots( self, MIN_SLOTS );
+    vector_clear( self->entries );
+    vector_clear( self->large );
+    vector_clear( self->bounds );
+    vector_clear( self->stamps );
+    self->free = NONE;
+    self->stamp = 0;
+    self->extent = (ivec4) {{ INT_MAX, INT_MAX, INT_MIN, INT_MIN }};
+}
+
+
+// ----------------------------------------------------- spatial_index_size ---
+size_t
+spatial_index_size( const spatial_index_t * self )
+{
+    assert( self );
+
+    return self->bounds->size;
+}
+
+
+// ---------------------------------------------------- spatial_index_coord ---
+int
+spatial_index_coord( const spatial_index_t * self, float v )
+{
+    double c = floor( v / self->cell_size );
+    if( c < -(INT_MAX/2) ) return -(INT_MAX/2);
+    if( c >  (INT_MAX/2) ) return  (INT_MAX/2);
+    return (int) c;
+}
+
+
+// ---------------------------------------------------- spatial_index_range ---
+// Range of cells overlapped by a box (xmin, ymin, xmax, ymax).
+ivec4
+spatial_index_range( const spatial_index_t * self, vec4 box )
+{
+    ivec4 range = {{ spatial_index_coord( self, box.x ),
+                     spatial_index_coord( self, box.y ),
+                     spatial_index_coord( self, box.x + box.z ),
+                     spatial_index_coord( self, box.y + box.w ) }};
+    return range;
+}
+
+
+// ----------------------------------------------------- spatial_index_slot ---
+// Slot of cell (x,y), or of the empty slot where it would be stored.
+size_t
+spatial_index_slot( const spatial_index_t * self, int x, int y )
+{
+    const spatial_cell_t * cells = (const spatial_cell_t *) self->cells->items;
+    size_t mask = self->cells->size - 1;
+    size_t i = ((unsigned int) x * 73856093u ^ (unsigned int) y * 19349663u)
+             & mask;
+
+    while( (cells[i].x != CELL_EMPTY) &&
+           ((cells[i].x != x) || (cells[i].y != y)) )
+    {
+        i = (i+1) & mask;
+    }
+    return i;
+}
+
+
+// ----------------------------------------------------- spatial_index_cell ---
+// Cell (x,y), created if needed.
+spatial_cell_t *
+spatial_index_cell( spatial_index_t * self, int x, int y )
+{
+    spatial_cell_t * cells = (spatial_cell_t *) self->cells->items;
+    size_t i = spatial_index_slot( self, x, y );
+
+    if( cells[i].x != CELL_EMPTY )
+    {
+        return &cells[i];
+    }
+
+    // Keep the load factor under one half
+    if( 2*(self->n_cells+1) > self->cells->size )
+    {
+        size_t n = self->cells->size, j;
+        spatial_cell_t * old =
+            (spatial_cell_t *) malloc( n*sizeof(spatial_cell_t) );
+        if( !old )
+        {
+            fprintf( stderr, "line %d: No more memory for allocating data\n",
+                     __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        memcpy( old, cells, n*sizeof(spatial_cell_t) );
+        spatial_index_slots( self, 2*n );
+        cells = (spatial_cell_t *) self->cells->items;
+        for( j=0; j<n; ++j )
+        {
+            if( old[j].x != CELL_EMPTY )
+            {
+                cells[spatial_index_slot( self, old[j].x, old[j].y )] = old[j];
+                self->n_cells++;
+            }
+        }
+        free( old );
+        i = spatial_index_slot( self, x, y );
+    }
+    cells[i].x = x;
+    cells[i].y = y;
+    cells[i].head = NONE;
+    self->n_cells++;
+
+    if( x < self->extent.x ) self->extent.x = x;
+    if( y < self->extent.y ) self->extent.y = y;
+    if( x > self->extent.z ) self->extent.z = x;
+    if( y > self->extent.w ) self->extent.w = y;
+    return &cells[i];
+}
+
+
+// ----------------------------------------------------- spatial_index_find ---
+// Cell (x,y) or NULL if not occupied.
+const spatial_cell_t *
+spatial_index_find( const spatial_index_t * self, int x, int y )
+{
+    const spatial_cell_t * cells = (const spatial_cell_t *) self->cells->items;
+    size_t i = spatial_index_slot( self, x, y );
+
+    return (cells[i].x != CELL_EMPTY) ? &cells[i] : 0;
+}
+
+
+// ---------------------------------------------------- spatial_index_large ---
+int
+spatial_index_large( ivec4 range )
+{
+    return ((double) (range.z - range.x + 1) *
+            (double) (range.w - range.y + 1)) > MAX_CELLS;
+}
+
+
+// ------------------------------------------------- spatial_index_register ---
+void
+spatial_index_register( spatial_index_t * self, size_t id )
+{
+    vec4 box = *(vec4 *) vector_get( self->bounds, id );
+    if( box.z < 0 )
+    {
+        return;
+    }
+    ivec4 range = spatial_index_range( self, box );
+    if( spatial_index_large( range ) )
+    {
+        vector_push_back( self->large, &id );
+        return;
+    }
+
+    int x, y;
+    for( y=range.y; y<=range.w; ++y )
+    {
+        for( x=range.x; x<=range.z; ++x )
+        {
+            spatial_cell_t * cell = spatial_index_cell( self, x, y );
+            spatial_entry_t entry = { id, cell->head };
+            size_t e = self->free;
+            if( e != NONE )
+            {
+                spatial_entry_t * free_entry = (spatial_entry_t *)
+                    vector_get( self->entries, e );
+                self->free = free_entry->next;
+                *free_entry = entry;
+            }
+            else
+            {
+                e = self->entries->size;
+                vector_push_back( self->entries, &entry );
+            }
+            cell->head = e;
+        }
+    }
+}
+
+
+// ----------------------------------------------- spatial_index_unregister ---
+void
+spatial_index_unregister( spatial_index_t * self, size_t id )
+{
+    vec4 box = *(vec4 *) vector_get( self->bounds, id );
+    size_t i;
+
+    if( box.z < 0 )
+    {
+        return;
+    }
+    ivec4 range = spatial_index_range( self, box );
+    if( spatial_index_large( range ) )
+    {
+        size_t * large = (size_t *) self->large->items;
+        for( i=0; i<self->large->size; ++i )
+        {
+            if( large[i] == id )
+            {
+                vector_erase( self->large, i );
+                break;
+            }
+        }
+        return;
+    }
+
+    spatial_entry_t * entries = (spatial_entry_t *) self->entries->items;
+    spatial_cell_t * cells = (spatial_cell_t *) self->cells->items;
+    int x, y;
+    for( y=range.y; y<=range.w; ++y )
+    {
+        for( x=range.x; x<=range.z; ++x )
+        {
+            size_t * link = &cells[spatial_index_slot( self, x, y )].head;
+            while( *link != NONE )
+            {
+                size_t e = *link;
+                if( entries[e].item == id )
+                {
+                    *link = entries[e].next;
+                    entries[e].next = self->free;
+                    self->free = e;
+                    break;
+                }
+                link = &entries[e].next;
+            }
+        }
+    }
+}
+
+
+// ---------------------------------------------------- spatial_index_shift ---
+// Adds delta to every identifier greater or equal to id.
+void
+spatial_index_shift( spatial_index_t * self, size_t id, int delta )
+{
+    spatial_entry_t * entries = (spatial_entry_t *) self->entries->items;
+    size_t * large = (size_t *) self->large->items;
+    size_t i;
+
+    for( i=0; i<self->entries->size; ++i )
+    {
+        if( (entries[i].item != NONE) && (entries[i].item >= id) )
+        {
+            entries[i].item += delta;
+        }
+    }
+    for( i=0; i<self->large->size; ++i )
+    {
+        if( large[i] >= id )
+        {
+            large[i] += delta;
+        }
+    }
+}
+
+
+// --------------------------------------------------- spatial_index_insert ---
+void
+spatial_index_insert( spatial_index_t * self, size_t id, vec4 box )
+{
+    assert( self );
+    assert( id <= self->bounds->size );
+
+    unsigned int stamp = 0;
+    if( id < self->bounds->size )
+    {
+        spatial_index_shift( self, id, +1 );
+    }
+    vector_insert( self->bounds, id, &box );
+    vector_insert( self->stamps, id, &stamp );
+    spatial_index_register( self, id );
+}
+
+
+// ---------------------------------------------------- spatial_index_erase ---
+void
+spatial_index_erase( spatial_index_t * self, size_t id )
+{
+    assert( self );
+    assert( id < self->bounds->size );
+
+    spatial_index_unregister( self, id );
+    vector_erase( self->bounds, id );
+    vector_erase( self->stamps, id );
+    if( id < self->bounds->size )
+    {
+        spatial_index_shift( self, id+1, -1 );
+    }
+}
+
+
+// --------------------------------------------------- spatial_index_update ---
+void
+spatial_index_update( spatial_index_t * self, size_t id, vec4 box )
+{
+    assert( self );
+    assert( id < self->bounds->size );
+
+    spatial_index_unregister( self, id );
+    *(vec4 *) vector_get( self->bounds, id ) = box;
+    spatial_index_register( self, id );
+}
+
+
+// ---------------------------------------------------- spatial_index_visit ---
+// Appends the unvisited boxes of a cell intersecting a rectangle.
+void
+spatial_index_visit( spatial_index_t * self, const spatial_cell_t * cell,
+                     vec4 rect, vector_t * result )
+{
+    const spatial_entry_t * entries =
+        (const spatial_entry_t *) self->entries->items;
+    const vec4 * bounds = (const vec4 *) self->bounds->items;
+    unsigned int * stamps = (unsigned int *) self->stamps->items;
+    size_t e;
+
+    for( e=cell->head; e!=NONE; e=entries[e].next )
+    {
+        size_t id = entries[e].item;
+        if( stamps[id] == self->stamp )
+        {
+            continue;
+        }
+        stamps[id] = self->stamp;
+        vec4 b = bounds[id];
+        if( (b.x <= rect.x + rect.z) && (b.x + b.z >= rect.x) &&
+            (b.y <= rect.y + rect.w) && (b.y + b.w >= rect.y) )
+        {
+            vector_push_back( result, &id );
+        }
+    }
+}
+
+
+// -------------------------------------------------- spatial_index_compare ---
+int
+spatial_index_compare( const void * a, const void * b )
+{
+    size_t i = *(const size_t *) a;
+    size_t j = *(const size_t *) b;
+    return (i > j) - (i < j);
+}
+
+
+// ---------------------------------------------------- spatial_index_query ---
+size_t
+spatial_index_query( spatial_index_t * self, vec4 rect, vector_t * result )
+{
+    assert( self );
+    assert( result );
+    assert( result->item_size == sizeof(size_t) );
+
+    const spatial_cell_t * cells = (const spatial_cell_t *) self->cells->items;
+    const vec4 * bounds = (const vec4 *) self->bounds->items;
+    ivec4 range = spatial_index_range( self, rect );
+    size_t i;
+    int x, y;
+
+    vector_clear( result );
+    if( ++self->stamp == 0 )
+    {
+        memset( self->stamps->items, 0,
+                self->stamps->size * sizeof(unsigned int) );
+        self->stamp = 1;
+    }
+
+    // Walk the range of cells, or the occupied cells if there are fewer
+    if( range.x < self->extent.x ) range.x = self->extent.x;
+    if( range.y < self->extent.y ) range.y = self->extent.y;
+    if( range.z > self->extent.z ) range.z = self->extent.z;
+    if( range.w > self->extent.w ) range.w = self->extent.w;
+    if( (range.x <= range.z) && (range.y <= range.w) )
+    {
+        if( ((double) (range.z - range.x + 1) *
+             (double) (range.w - range.y + 1)) <= self->n_cells )
+        {
+            for( y=range.y; y<=range.w; ++y )
+            {
+                for( x=range.x; x<=range.z; ++x )
+                {
+                    const spatial_cell_t * cell;
+                    cell = spatial_index_find( self, x, y );
+                    if( cell )
+                    {
+                        spatial_index_visit( self, cell, rect, result );
+                    }
+                }
+            }
+        }
+        else
+        {
+            for( i=0; i<self->cells->size; ++i )
+            {
+                if( (cells[i].x != CELL_EMPTY) &&
+                    (cells[i].x >= range.x) && (cells[i].x <= range.z) &&
+                    (cells[i].y >= range.y) && (cells[i].y <= range.w) )
+                {
+                    spatial_index_visit( self, &cells[i], rect, result );
+                }
+            }
+        }
+    }
+
+    for( i=0; i<self->large->size; ++i )
+    {
+        size_t id = *(size_t *) vector_get( self->large, i );
+        vec4 b = bounds[id];
+        if( (b.x <= rect.x + rect.z) && (b.x + b.z >= rect.x) &&
+            (b.y <= rect.y + rect.w) && (b.y + b.w >= rect.y) )
+        {
+            vector_push_back( result, &id );
+        }
+    }
+
+    // Identifiers in increasing order
+    qsort( result->items, result->size, sizeof(size_t),
+           spatial_index_compare );
+    return result->size;
+}
+
+
+// ------------------------------------------------- spatial_index_distance ---
+// Squared distance from a point to a box.
+double
+spatial_index_distance( vec4 box, vec2 p )
+{
+    double dx = 0, dy = 0;
+    if( p.x < box.x )              dx = box.x - p.x;
+    else if( p.x > box.x + box.z ) dx = p.x - (box.x + box.z);
+    if( p.y < box.y )              dy = box.y - p.y;
+    else if( p.y > box.y + box.w ) dy = p.y - (box.y + box.w);
+    return dx*dx + dy*dy;
+}
+
+
+// -------------------------------------------------- spatial_index_closest ---
+// Updates the best box with the boxes of a cell.
+void
+spatial_index_closest( const spatial_index_t * self,
+                       const spatial_cell_t * cell, vec2 p,
+                       size_t * best, double * best_d )
+{
+    const spatial_entry_t * entries =
+        (const spatial_entry_t *) self->entries->items;
+    const vec4 * bounds = (const vec4 *) self->bounds->items;
+    size_t e;
+
+    for( e=cell->head; e!=NONE; e=entries[e].next )
+    {
+        size_t id = entries[e].item;
+        double d = spatial_index_distance( bounds[id], p );
+        if( (d < *best_d) ||
+            ((d == *best_d) && ((*best == NONE) || (id > *best))) )
+        {
+            *best = id;
+            *best_d = d;
+        }
+    }
+}
+
+
+// -------------------------------------------------- spatial_index_nearest ---
+size_t
+spatial_index_nearest( spatial_index_t * self, vec2 p, float max_distance )
+{
+    assert( self );
+
+    const spatial_cell_t * cells = (const spatial_cell_t *) self->cells->items;
+    const vec4 * bounds = (const vec4 *) self->bounds->items;
+    double best_d = (double) max_distance * (double) max_distance;
+    size_t i, best = NONE;
+
+    for( i=0; i<self->large->size; ++i )
+    {
+        size_t id = *(size_t *) vector_get( self->large, i );
+        double d = spatial_index_distance( bounds[id], p );
+        if( (d < best_d) ||
+            ((d == best_d) && ((best == NONE) || (id > best))) )
+        {
+            best = id;
+            best_d = d;
+        }
+    }
+    if( !self->n_cells )
+    {
+        return best;
+    }
+
+    // Rings of cells around the point: boxes not registered into the first
+    // r rings are at least (r-1) cells away
+    int cx = spatial_index_coord( self, p.x );
+    int cy = spatial_index_coord( self, p.y );
+    int r, k, r_max = 0;
+    r_max = max( r_max, cx - self->extent.x );
+    r_max = max( r_max, self->extent.z - cx );
+    r_max = max( r_max, cy - self->extent.y );
+    r_max = max( r_max, self->extent.w - cy );
+    for( r=0; r<=r_max; ++r )
+    {
+        double reach = (r-1) * (double) self->cell_size;
+        if( (r > 1) && (reach*reach > best_d) )
+        {
+            break;
+        }
+
+        // Remaining rings have more cells than the table: scan it once
+        if( (8.0*r) > self->n_cells )
+        {
+            for( i=0; i<self->cells->size; ++i )
+            {
+                int dx = abs( cells[i].x - cx );
+                int dy = abs( cells[i].y - cy );
+                if( (cells[i].x != CELL_EMPTY) && (max( dx, dy ) >= r) )
+                {
+                    spatial_index_closest( self, &cells[i], p,
+                                           &best, &best_d );
+                }
+            }
+            break;
+        }
+        for( k=-r; k<=r; ++k )
+        {
+            const spatial_cell_t * ring[4] = { 0, 0, 0, 0 };
+            ring[0] = spatial_index_find( self, cx+k, cy-r );
+            if( r )
+            {
+                ring[1] = spatial_index_find( self, cx+k, cy+r );
+                if( (k > -r) && (k < r) )
+                {
+                    ring[2] = spatial_index_find( self, cx-r, cy+k );
+                    ring[3] = spatial_index_find( self, cx+r, cy+k );
+                }
+            }
+            size_t j;
+            for( j=0; j<4; ++j )
+            {
+                if( ring[j] )
+                {
+                    spatial_index_closest( self, ring[j], p, &best, &best_d );
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,217 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __SPATIAL_INDEX_H__
+#define __SPATIAL_INDEX_H__
+#include <stddef.h>
+
+#include "vec234.h"
+#include "vector.h"
+
+
+/**
+ * @file   spatial-index.h
+ *
+ * @defgroup spatial-index Spatial index
+ *
+ * Dynamic spatial index of axis aligned bounding boxes identified by
+ * consecutive integers (the items of a vertex buffer). Boxes are registered
+ * into the cells of a uniform grid they overlap, cells being stored into a
+ * hash table such that only occupied cells cost memory. Boxes overlapping
+ * too many cells are kept aside in a list of large boxes that every query
+ * checks.
+ *
+ * Inserting or erasing the last box is O(1) (times the number of cells it
+ * overlaps). Inserting or erasing another box renumbers the following
+ * boxes, which is O(n).
+ *
+ * Example Usage:
+ * @code
+ * spatial_index_t * index = spatial_index_new( 64 );
+ * spatial_index_insert( index, 0, (vec4) {{ 10, 10, 100, 20 }} );
+ * spatial_index_query( index, (vec4) {{ 0, 0, 50, 50 }}, result );
+ * spatial_index_delete( index );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Spatial index.
+ */
+typedef struct
+{
+    /** Size of a grid cell. */
+    float cell_size;
+
+    /** Hash table of occupied cells. */
+    vector_t * cells;
+
+    /** Number of occupied cells. */
+    size_t n_cells;
+
+    /** Registrations of boxes into cells (linked lists, one per cell). */
+    vector_t * entries;
+
+    /** First free entry. */
+    size_t free;
+
+    /** Identifiers of large boxes. */
+    vector_t * large;
+
+    /** Box of each identifier (x, y, width, height), width < 0 if empty. */
+    vector_t * bounds;
+
+    /** Last query each identifier has been visited by. */
+    vector_t * stamps;
+
+    /** Current query. */
+    unsigned int stamp;
+
+    /** Range of occupied cells (xmin, ymin, xmax, ymax). */
+    ivec4 extent;
+} spatial_index_t;
+
+
+/**
+ * Creates a new empty spatial index.
+ *
+ * @param  cell_size  size of a grid cell (typically a few times the size
+ *                    of common boxes)
+ * @return            a new empty spatial index
+ */
+  spatial_index_t *
+  spatial_index_new( float cell_size );
+
+
+/**
+ * Deletes a spatial index.
+ *
+ * @param  self  a spatial index
+ */
+  void
+  spatial_index_delete( spatial_index_t * self );
+
+
+/**
+ * Removes all boxes of a spatial index.
+ *
+ * @param  self  a spatial index
+ */
+  void
+  spatial_index_clear( spatial_index_t * self );
+
+
+/**
+ * Returns the number of boxes of a spatial index.
+ *
+ * @param  self  a spatial index
+ * @return       number of boxes
+ */
+  size_t
+  spatial_index_size( const spatial_index_t * self );
+
+
+/**
+ * Inserts a box, boxes with an identifier greater or equal to the given
+ * one being renumbered.
+ *
+ * @param  self  a spatial index
+ * @param  id    identifier of the box (at most the number of boxes)
+ * @param  box   box (x, y, width, height), width < 0 for an empty box
+ */
+  void
+  spatial_index_insert( spatial_index_t * self, size_t id, vec4 box );
+
+
+/**
+ * Erases a box, boxes with a greater identifier being renumbered.
+ *
+ * @param  self  a spatial index
+ * @param  id    identifier of the box
+ */
+  void
+  spatial_index_erase( spatial_index_t * self, size_t id );
+
+
+/**
+ * Replaces the box of an identifier.
+ *
+ * @param  self  a spatial index
+ * @param  id    identifier of the box
+ * @param  box   new box (x, y, width, height), width < 0 for an empty box
+ */
+  void
+  spatial_index_update( spatial_index_t * self, size_t id, vec4 box );
+
+
+/**
+ * Finds the boxes intersecting a rectangle.
+ *
+ * @param  self    a spatial index
+ * @param  rect    rectangle (x, y, width, height)
+ * @param  result  vector of size_t receiving the identifiers of the boxes,
+ *                 in increasing order
+ * @return         number of boxes found
+ */
+  size_t
+  spatial_index_query( spatial_index_t * self, vec4 rect, vector_t * result );
+
+
+/**
+ * Finds the box nearest to a point. Among boxes at the same distance, the
+ * one with the greatest identifier is returned.
+ *
+ * @param  self          a spatial index
+ * @param  point         a point
+ * @param  max_distance  maximum distance from the point to the box
+ * @return               identifier of the box, (size_t) -1 if none
+ */
+  size_t
+  spatial_index_nearest( spatial_index_t * self, vec2 point,
+                         float max_distance );
+
+
+/**
+ * Returns the squared distance from a point to a box.
+ *
+ * @param  box    box (x, y, width, height)
+ * @param  point  a point
+ * @return        squared distance, 0 if the box contains the point
+ */
+  double
+  spatial_index_distance( vec4 box, vec2 point );
+
+/** @} */
+
+#endif /* __SPATIAL_INDEX_H__ */
@@ -0,0 +1,153 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __TYPED_VECTOR_H__
+#define __TYPED_VECTOR_H__
+#include <assert.h>
+#include <string.h>
+
+#include "vec234.h"
+#include "vector.h"
+
+
+/**
+ * @file   typed-vector.h
+ *
+ * @defgroup typed-vector Typed vector operations
+ *
+ * Inlined operations on vectors whose item type is known at compile time.
+ * Generic vector functions multiply by item_size and copy each item with
+ * memcpy; the typed ones below index a typed pointer instead, so that a
+ * push back in a tight loop compiles to a capacity check and a plain
+ * store. They operate on regular vector_t structures (allocated with
+ * vector_new( sizeof(type) ) or vector_new_with_allocator) and can be
+ * freely mixed with the generic functions.
+ *
+ * TYPED_VECTOR( name, type ) defines:
+ *
+ *  - type * name_data( vector_t * ): items as a typed array
+ *  - type   name_get( const vector_t *, size_t ): item by value
+ *  - type * name_at( vector_t *, size_t ): pointer to an item
+ *  - void   name_push_back( vector_t *, type ): append an item
+ *  - void   name_append( vector_t *, const type *, size_t ): append items
+ *  - type * name_extend( vector_t *, size_t ): append uninitialized items
+ *           and return a pointer to the first one
+ *
+ * Example Usage:
+ * @code
+ * vector_t * points = vector_new( sizeof(vec2) );
+ * vec2 p = {{1,2}};
+ * vec2_vector_push_back( points, p );
+ * p = vec2_vector_get( points, 0 );
+ * vector_delete( points );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Defines typed operations named name_* on vectors of type items.
+ */
+#define TYPED_VECTOR( name, type )                                           \
+                                                                             \
+static inline type *                                                         \
+name##_data( vector_t * self )                                               \
+{                                                                            \
+    assert( self->item_size == sizeof(type) );                               \
+    return (type *) self->items;                                             \
+}                                                                            \
+                                                                             \
+static inline type                                                           \
+name##_get( const vector_t * self, size_t index )                            \
+{                                                                            \
+    assert( index < self->size );                                            \
+    return ((const type *) self->items)[index];                              \
+}                                                                            \
+                                                                             \
+static inline type *                                                         \
+name##_at( vector_t * self, size_t index )                                   \
+{                                                                            \
+    assert( index < self->size );                                            \
+    return (type *) self->items + index;                                     \
+}                                                                            \
+                                                                             \
+static inline type *                                                         \
+name##_extend( vector_t * self, size_t count )                               \
+{                                                                            \
+    assert( self->item_size == sizeof(type) );                               \
+    if( self->capacity < self->size + count )                                \
+    {                                                                        \
+        size_t capacity = 2 * self->capacity;                                \
+        vector_reserve( self, capacity < self->size + count                  \
+                              ? self->size + count : capacity );             \
+    }                                                                        \
+    self->size += count;                                                     \
+    return (type *) self->items + self->size - count;                        \
+}                                                                            \
+                                                                             \
+static inline void                                                           \
+name##_push_back( vector_t * self, type value )                              \
+{                                                                            \
+    assert( self->item_size == sizeof(type) );                               \
+    if( self->size == self->capacity )                                       \
+    {                                                                        \
+        vector_reserve( self, self->capacity ? 2 * self->capacity : 1 );     \
+    }                                                                        \
+    ((type *) self->items)[self->size++] = value;                            \
+}                                                                            \
+                                                                             \
+static inline void                                                           \
+name##_append( vector_t * self, const type * values, size_t count )          \
+{                                                                            \
+    if( count )                                                              \
+    {                                                                        \
+        memcpy( name##_extend( self, count ), values, count*sizeof(type) );  \
+    }                                                                        \
+}
+
+
+/** Typed operations on vectors of vec2. */
+TYPED_VECTOR( vec2_vector, vec2 )
+
+/** Typed operations on vectors of ivec2. */
+TYPED_VECTOR( ivec2_vector, ivec2 )
+
+/** Typed operations on vectors of ivec4. */
+TYPED_VECTOR( ivec4_vector, ivec4 )
+
+/** Typed operations on vectors of size_t. */
+TYPED_VECTOR( size_vector, size_t )
+
+/** @} */
+
+#endif /* __TYPED_VECTOR_H__ */
@@ -0,0 +1,527 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __TYPED_VERTEX_BUFFER_HPP__
+#define __TYPED_VERTEX_BUFFER_HPP__
+#include <assert.h>
+#include <stddef.h>
+#include <string>
+
+extern "C" {
+#include "vertex-buffer.h"
+}
+
+
+/**
+ * @file   typed-vertex-buffer.hpp
+ *
+ * @defgroup typed-vertex-buffer Typed vertex buffer (C++)
+ *
+ * Header only C++ layer over vertex buffers whose layout is a list of
+ * attribute types instead of a format string. Stride, offsets and GL types
+ * of a layout are compile time constants and its vertex type is a plain
+ * structure of exactly stride bytes, so that vertices are written in place
+ * without any format check or memcpy of item_size bytes, and passing
+ * vertices of another layout is a compile error.
+ *
+ * The underlying vertex_buffer_t (see get) uses the format string of the
+ * layout, interned once, and can be given to the C functions.
+ *
+ * Example Usage:
+ * @code
+ * typedef agg::vertex_layout< agg::position<float,2>,
+ *                             agg::color<float,4> > layout;
+ * agg::typed_vertex_buffer<layout> buffer;
+ * buffer.emplace_back( {{ 0, 0 }}, {{ 1, 0, 0, 1 }} );
+ * buffer.emplace_back( {{ 1, 0 }}, {{ 0, 1, 0, 1 }} );
+ * vertex_buffer_render( buffer.get( ), GL_LINES, "vc" );
+ * @endcode
+ *
+ * @{
+ */
+namespace agg
+{
+
+/**
+ * GL type and format letter of a component type.
+ */
+template< typename T > struct gl_type;
+
+template<> struct gl_type< GLbyte >
+{
+    static const GLenum value = GL_BYTE;
+    static const char code = 'b';
+};
+template<> struct gl_type< GLubyte >
+{
+    static const GLenum value = GL_UNSIGNED_BYTE;
+    static const char code = 'B';
+};
+template<> struct gl_type< GLshort >
+{
+    static const GLenum value = GL_SHORT;
+    static const char code = 's';
+};
+template<> struct gl_type< GLushort >
+{
+    static const GLenum value = GL_UNSIGNED_SHORT;
+    static const char code = 'S';
+};
+template<> struct gl_type< GLint >
+{
+    static const GLenum value = GL_INT;
+    static const char code = 'i';
+};
+template<> struct gl_type< GLuint >
+{
+    static const GLenum value = GL_UNSIGNED_INT;
+    static const char code = 'I';
+};
+template<> struct gl_type< GLfloat >
+{
+    static const GLenum value = GL_FLOAT;
+    static const char code = 'f';
+};
+template<> struct gl_type< GLdouble >
+{
+    static const GLenum value = GL_DOUBLE;
+    static const char code = 'd';
+};
+
+
+/**
+ * Vertex attribute of Size components of type T, Target being one of the
+ * known attribute letters ("vcntfse") or 'g' for a generic attribute at
+ * location Index.
+ */
+template< char Target, typename T, int Size,
+          GLuint Index = 0, bool Normalized = false >
+struct attribute
+{
+    static_assert( Size >= 1 && Size <= 4, "1 to 4 components" );
+    static_assert( Target != 'g' || Index < MAX_VERTEX_ATTRIBUTE,
+                   "generic attribute index out of range" );
+
+    /** Component type. */
+    typedef T component_type;
+
+    /** Value of the attribute in a vertex. */
+    struct value { T data[Size]; };
+
+    static constexpr char target = Target;
+    static constexpr int size = Size;
+    static constexpr GLuint index = Index;
+    static constexpr bool normalized = Normalized;
+    static constexpr GLenum type = gl_type< T >::value;
+    static constexpr size_t bytes = Size * sizeof( T );
+
+    /** Appends the attribute format ("v3f", "1gn4f", ...) to format. */
+    static void
+    format( std::string & format )
+    {
+        if( Target == 'g' )
+        {
+            format += std::to_string( Index ) + 'g';
+            if( Normalized )
+            {
+                format += 'n';
+            }
+        }
+        else
+        {
+            format += Target;
+        }
+        format += char( '0' + Size );
+        format += gl_type< T >::code;
+    }
+};
+
+template< typename T, int Size >
+using position = attribute< 'v', T, Size >;
+
+template< typename T, int Size >
+using color = attribute< 'c', T, Size >;
+
+template< typename T, int Size >
+using normal = attribute< 'n', T, Size >;
+
+template< typename T, int Size >
+using tex_coord = attribute< 't', T, Size >;
+
+template< typename T, int Size >
+using fog_coord = attribute< 'f', T, Size >;
+
+template< typename T, int Size >
+using secondary_color = attribute< 's', T, Size >;
+
+template< typename T, int Size >
+using edge_flag = attribute< 'e', T, Size >;
+
+template< GLuint Index, typename T, int Size, bool Normalized = false >
+using generic = attribute< 'g', T, Size, Index, Normalized >;
+
+
+namespace detail
+{
+// --------------------------------------------------------------- element ---
+template< size_t I, typename... A > struct element;
+
+template< typename H, typename... T >
+struct element< 0, H, T... > { typedef H type; };
+
+template< size_t I, typename H, typename... T >
+struct element< I, H, T... > : element< I-1, T... > { };
+
+
+// ---------------------------------------------------------------- offset ---
+template< size_t I, typename... A >
+struct offset
+{
+    static constexpr size_t value = 0;
+};
+
+template< size_t I, typename H, typename... T >
+struct offset< I, H, T... >
+{
+    static constexpr size_t value =
+        I ? H::bytes + offset< (I ? I-1 : 0), T... >::value : 0;
+};
+
+
+// ----------------------------------------------------------- vertex_data ---
+template< typename... A > struct vertex_data;
+
+template< typename H >
+struct vertex_data< H >
+{
+    typename H::value head;
+};
+
+template< typename H, typename H2, typename... T >
+struct vertex_data< H, H2, T... >
+{
+    typename H::value head;
+    vertex_data< H2, T... > tail;
+};
+
+
+// ------------------------------------------------------------------ make ---
+template< typename H >
+inline vertex_data< H >
+make( const typename H::value & head )
+{
+    vertex_data< H > data = { head };
+    return data;
+}
+
+template< typename H, typename H2, typename... T >
+inline vertex_data< H, H2, T... >
+make( const typename H::value & head,
+      const typename H2::value & head2,
+      const typename T::value &... tail )
+{
+    vertex_data< H, H2, T... > data = { head,
+                                        make< H2, T... >( head2, tail... ) };
+    return data;
+}
+
+
+// ----------------------------------------------------------------- field ---
+template< size_t I >
+struct field
+{
+    template< typename... A >
+    static typename element< I, A... >::type::value &
+    get( vertex_data< A... > & data )
+    {
+        return field< I-1 >::get( data.tail );
+    }
+};
+
+template<>
+struct field< 0 >
+{
+    template< typename... A >
+    static typename element< 0, A... >::type::value &
+    get( vertex_data< A... > & data )
+    {
+        return data.head;
+    }
+};
+
+
+// ---------------------------------------------------------------- format ---
+inline void
+format( std::string & )
+{ }
+
+template< typename H, typename... T >
+inline void
+format( std::string & format, H *, T *... tail )
+{
+    if( !format.empty( ) )
+    {
+        format += ':';
+    }
+    H::format( format );
+    detail::format( format, tail... );
+}
+}
+
+
+/**
+ * Vertex layout made of the given attributes, in order.
+ */
+template< typename... A >
+struct vertex_layout
+{
+    static_assert( sizeof...(A) >= 1 &&
+                   sizeof...(A) <= MAX_VERTEX_ATTRIBUTE,
+                   "1 to MAX_VERTEX_ATTRIBUTE attributes" );
+
+    /** Vertex, a plain structure of stride bytes. */
+    typedef detail::vertex_data< A... > vertex_type;
+
+    /** Type of the I-th attribute. */
+    template< size_t I >
+    using attribute = typename detail::element< I, A... >::type;
+
+    /** Number of attributes. */
+    static constexpr size_t count = sizeof...(A);
+
+    /** Size of a vertex in bytes. */
+    static constexpr size_t stride =
+        detail::offset< sizeof...(A), A... >::value;
+
+    /** Offset of the I-th attribute in a vertex. */
+    template< size_t I >
+    static constexpr size_t
+    offset( )
+    {
+        return detail::offset< I, A... >::value;
+    }
+
+    static_assert( sizeof( vertex_type ) == stride,
+                   "attributes of this layout would be padded, reorder "
+                   "them by decreasing component size" );
+
+    /** Format string of the layout, built once. */
+    static const char *
+    format( )
+    {
+        static const std::string format = build_format( );
+        return format.c_str( );
+    }
+
+    /** Vertex made of the values of its attributes. */
+    static vertex_type
+    make( const typename A::value &... values )
+    {
+        return detail::make< A... >( values... );
+    }
+
+    /** I-th attribute of a vertex. */
+    template< size_t I >
+    static typename attribute< I >::value &
+    get( vertex_type & vertex )
+    {
+        return detail::field< I >::get( vertex );
+    }
+
+private:
+    static std::string
+    build_format( )
+    {
+        std::string format;
+        detail::format( format, (A *) 0 ... );
+        return format;
+    }
+};
+
+
+/** Layout of the vertices written by the library tessellators. */
+typedef vertex_layout< position< GLfloat, 3 >,
+                       color< GLfloat, 4 >,
+                       tex_coord< GLfloat, 3 > > v3f_c4f_t3f;
+
+/** Layout of the vertices written by vertex_buffer_add_line_2. */
+typedef vertex_layout< position< GLfloat, 3 >,
+                       color< GLfloat, 4 >,
+                       tex_coord< GLfloat, 4 > > v3f_c4f_t4f;
+
+
+/**
+ * Vertex buffer of the given layout (a vertex_layout), owning a
+ * vertex_buffer_t.
+ */
+template< typename Layout > class typed_vertex_buffer;
+
+template< typename... A >
+class typed_vertex_buffer< vertex_layout< A... > >
+{
+public:
+    typedef vertex_layout< A... > Layout;
+    typedef Layout layout_type;
+    typedef typename Layout::vertex_type vertex_type;
+
+    /** Creates an empty buffer (see vertex_buffer_new_with_allocator). */
+    explicit
+    typed_vertex_buffer( const allocator_t * allocator = 0 )
+        : self( vertex_buffer_new_with_allocator( Layout::format( ),
+                                                  allocator ) )
+    {
+        assert( self );
+        assert( (size_t) self->descriptor->stride == Layout::stride );
+        assert( self->vertices->item_size == sizeof( vertex_type ) );
+    }
+
+    ~typed_vertex_buffer( )
+    {
+        if( self )
+        {
+            vertex_buffer_delete( self );
+        }
+    }
+
+    typed_vertex_buffer( typed_vertex_buffer && other )
+        : self( other.self )
+    {
+        other.self = 0;
+    }
+
+    typed_vertex_buffer &
+    operator=( typed_vertex_buffer && other )
+    {
+        if( this != &other )
+        {
+            if( self )
+            {
+                vertex_buffer_delete( self );
+            }
+            self = other.self;
+            other.self = 0;
+        }
+        return *this;
+    }
+
+    typed_vertex_buffer( const typed_vertex_buffer & ) = delete;
+    typed_vertex_buffer & operator=( const typed_vertex_buffer & ) = delete;
+
+    /** Underlying vertex buffer, for the C functions. */
+    vertex_buffer_t *
+    get( ) const
+    {
+        return self;
+    }
+
+    /** Number of vertices. */
+    size_t
+    vertex_count( ) const
+    {
+        return self->vertices->size;
+    }
+
+    /** Vertices as a typed array. */
+    vertex_type *
+    vertices( )
+    {
+        return (vertex_type *) self->vertices->items;
+    }
+
+    /**
+     * Appends a vertex built from the values of its attributes (see
+     * vertex_buffer_push_back_vertices).
+     */
+    void
+    emplace_back( const typename A::value &... values )
+    {
+        *extend( 1 ) = Layout::make( values... );
+    }
+
+    /** Appends vertices (see vertex_buffer_push_back_vertices). */
+    void
+    append( const vertex_type * vertices, size_t vcount )
+    {
+        vertex_type * V = extend( vcount );
+        for( size_t i=0; i<vcount; ++i )
+        {
+            V[i] = vertices[i];
+        }
+    }
+
+    /**
+     * Appends an item, indices being relative to its first vertex (see
+     * vertex_buffer_append).
+     *
+     * @return  handle of the new item
+     */
+    size_t
+    append( const vertex_type * vertices, size_t vcount,
+            const GLuint * indices, size_t icount )
+    {
+        return vertex_buffer_append( self,
+                                     const_cast<vertex_type *>( vertices ),
+                                     vcount,
+                                     const_cast<GLuint *>( indices ),
+                                     icount );
+    }
+
+private:
+    /** Appends count uninitialized vertices and returns the first one. */
+    vertex_type *
+    extend( size_t count )
+    {
+        assert( !self->vertex_chunks );
+        if( self->mapping )
+        {
+            vertex_buffer_unmap( self );
+        }
+        self->dirty = 1;
+        vector_t * V = self->vertices;
+        if( V->capacity < V->size + count )
+        {
+            size_t capacity = 2 * V->capacity;
+            vector_reserve( V, capacity < V->size + count
+                               ? V->size + count : capacity );
+        }
+        V->size += count;
+        return (vertex_type *) V->items + V->size - count;
+    }
+
+    vertex_buffer_t * self;
+};
+
+}
+
+/** @} */
+
+#endif /* __TYPED_VERTEX_BUFFER_HPP__ */
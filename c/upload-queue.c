@@ -0,0 +1,215 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "upload-queue.h"
+
+
+// ---------------------------------------------------- upload_queue_worker ---
+void *
+upload_queue_worker( void * data )
+{
+    upload_queue_t * self = (upload_queue_t *) data;
+    upload_job_t job;
+    GLuint ids[2];
+    size_t bytes;
+
+    (*self->make_current)( self->context );
+    pthread_mutex_lock( &self->lock );
+    while( 1 )
+    {
+        while( !self->pending->size && !self->quit )
+        {
+            pthread_cond_wait( &self->cond, &self->lock );
+        }
+        if( self->quit )
+        {
+            break;
+        }
+        job = *(upload_job_t *) vector_front( self->pending );
+        vector_erase( self->pending, 0 );
+        pthread_mutex_unlock( &self->lock );
+
+        // The fence is flushed such that the rendering context can wait
+        // for it
+        glGenBuffers( 2, ids );
+        bytes = vertex_buffer_upload_copy( job.buffer, ids[0], ids[1] );
+        job.vertices_id = ids[0];
+        job.indices_id = ids[1];
+        job.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+        glFlush( );
+
+        pthread_mutex_lock( &self->lock );
+        self->bytes += bytes;
+        vector_push_back( self->uploaded, &job );
+    }
+    pthread_mutex_unlock( &self->lock );
+    (*self->make_current)( 0 );
+    return NULL;
+}
+
+
+// ------------------------------------------------------- upload_queue_new ---
+upload_queue_t *
+upload_queue_new( void (*make_current)( void * context ),
+                  void * context )
+{
+    assert( make_current );
+
+    upload_queue_t * self =
+        (upload_queue_t *) malloc( sizeof(upload_queue_t) );
+    if( !self )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    pthread_mutex_init( &self->lock, NULL );
+    pthread_cond_init( &self->cond, NULL );
+    self->pending = vector_new( sizeof(upload_job_t) );
+    self->uploaded = vector_new( sizeof(upload_job_t) );
+    self->quit = 0;
+    self->make_current = make_current;
+    self->context = context;
+    self->bytes = 0;
+    if( pthread_create( &self->thread, NULL, upload_queue_worker, self ) )
+    {
+        fprintf( stderr,
+                 "line %d: Unable to start upload thread\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    return self;
+}
+
+
+// ---------------------------------------------------- upload_queue_delete ---
+void
+upload_queue_delete( upload_queue_t * self )
+{
+    size_t i;
+
+    assert( self );
+
+    pthread_mutex_lock( &self->lock );
+    self->quit = 1;
+    pthread_cond_broadcast( &self->cond );
+    pthread_mutex_unlock( &self->lock );
+    pthread_join( self->thread, NULL );
+
+    // Unswitched buffers are uploaded again when next rendered
+    for( i=0; i<self->uploaded->size; ++i )
+    {
+        upload_job_t * job = (upload_job_t *) vector_get( self->uploaded, i );
+        glDeleteSync( (GLsync) job->fence );
+        glDeleteBuffers( 1, &job->vertices_id );
+        glDeleteBuffers( 1, &job->indices_id );
+        job->buffer->uploading = 0;
+    }
+    for( i=0; i<self->pending->size; ++i )
+    {
+        upload_job_t * job = (upload_job_t *) vector_get( self->pending, i );
+        job->buffer->uploading = 0;
+    }
+    vector_delete( self->pending );
+    vector_delete( self->uploaded );
+    pthread_cond_destroy( &self->cond );
+    pthread_mutex_destroy( &self->lock );
+    free( self );
+}
+
+
+// ------------------------------------------------------ upload_queue_push ---
+void
+upload_queue_push( upload_queue_t * self,
+                   vertex_buffer_t * buffer )
+{
+    assert( self );
+    assert( buffer );
+    assert( !buffer->uploading );
+
+    upload_job_t job = { buffer, 0, 0, 0 };
+
+    vertex_buffer_close_gap( buffer );
+    buffer->uploading = 1;
+    pthread_mutex_lock( &self->lock );
+    vector_push_back( self->pending, &job );
+    pthread_cond_signal( &self->cond );
+    pthread_mutex_unlock( &self->lock );
+}
+
+
+// ------------------------------------------------------ upload_queue_poll ---
+size_t
+upload_queue_poll( upload_queue_t * self )
+{
+    size_t i = 0, switched = 0;
+
+    assert( self );
+
+    pthread_mutex_lock( &self->lock );
+    while( i < self->uploaded->size )
+    {
+        upload_job_t * job = (upload_job_t *) vector_get( self->uploaded, i );
+        GLenum status = glClientWaitSync( (GLsync) job->fence, 0, 0 );
+        if( (status != GL_ALREADY_SIGNALED) &&
+            (status != GL_CONDITION_SATISFIED) )
+        {
+            ++i;
+            continue;
+        }
+        glDeleteSync( (GLsync) job->fence );
+        vertex_buffer_swap_gpu_buffers( job->buffer,
+                                        job->vertices_id, job->indices_id );
+        job->buffer->uploading = 0;
+        vector_erase( self->uploaded, i );
+        switched++;
+    }
+    pthread_mutex_unlock( &self->lock );
+    return switched;
+}
+
+
+// ------------------------------------------------------ upload_queue_size ---
+size_t
+upload_queue_size( upload_queue_t * self )
+{
+    size_t size;
+
+    assert( self );
+
+    pthread_mutex_lock( &self->lock );
+    size = self->pending->size + self->uploaded->size;
+    pthread_mutex_unlock( &self->lock );
+    return size;
+}
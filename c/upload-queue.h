@@ -0,0 +1,187 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __UPLOAD_QUEUE_H__
+#define __UPLOAD_QUEUE_H__
+#include <stddef.h>
+#include <pthread.h>
+
+#include "vector.h"
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   upload-queue.h
+ *
+ * @defgroup upload-queue Upload queue
+ *
+ * Background upload of vertex buffers. A worker thread, whose GL context
+ * shares objects with the rendering one, copies queued buffers into new GL
+ * buffers and fences them. The rendering thread polls the queue once per
+ * frame and a buffer switches to its new GL buffers only when its fence
+ * has signaled, such that uploading a large dataset never blocks a frame
+ * inside glBufferData.
+ *
+ * Contexts are created by the application (GLX, EGL, OSMesa...): the
+ * queue only calls back on its worker thread to make the shared context
+ * current when it starts, and to release it when it stops. Queued buffers
+ * are neither rendered nor modified until switched: the application
+ * keeps rendering the previous buffers meanwhile.
+ *
+ * Example Usage:
+ * @code
+ * upload_queue_t * queue = upload_queue_new( make_current, shared );
+ * vertex_buffer_t * next = vertex_buffer_load_mmap( "dataset.vb", hash );
+ * upload_queue_push( queue, next );
+ *
+ * // every frame
+ * upload_queue_poll( queue );
+ * if( !next->uploading ) ...render next instead of the previous buffer...
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Upload of a buffer.
+ */
+typedef struct
+{
+    /** Buffer being uploaded. */
+    vertex_buffer_t * buffer;
+
+    /** New GL buffers of the vertices and indices. */
+    GLuint vertices_id, indices_id;
+
+    /** Fence signaled once the upload has completed (a GLsync). */
+    void * fence;
+} upload_job_t;
+
+
+/**
+ * Upload queue.
+ */
+typedef struct
+{
+    /** Worker thread. */
+    pthread_t thread;
+
+    /** Lock of the jobs and of quit. */
+    pthread_mutex_t lock;
+
+    /** Signaled when a job is pushed or the queue stops. */
+    pthread_cond_t cond;
+
+    /** Jobs waiting for the worker. */
+    vector_t * pending;
+
+    /** Jobs uploaded, waiting for their fence. */
+    vector_t * uploaded;
+
+    /** Whether the worker has to stop. */
+    int quit;
+
+    /**
+     * Makes context current on the calling (worker) thread, or releases
+     * the current context when given 0.
+     */
+    void (*make_current)( void * context );
+
+    /** Context sharing objects with the rendering one. */
+    void * context;
+
+    /** Number of bytes uploaded by the worker. */
+    size_t bytes;
+} upload_queue_t;
+
+
+/**
+ * Creates an upload queue and starts its worker thread.
+ *
+ * @param  make_current  makes a context current on the calling thread
+ *                       (0 to release it)
+ * @param  context       context sharing objects with the rendering one
+ * @return               a new upload queue
+ */
+  upload_queue_t *
+  upload_queue_new( void (*make_current)( void * context ),
+                    void * context );
+
+
+/**
+ * Stops the worker and deletes the queue, from the rendering thread.
+ * Buffers whose upload has not been switched are left to be uploaded when
+ * next rendered.
+ *
+ * @param  self  an upload queue
+ */
+  void
+  upload_queue_delete( upload_queue_t * self );
+
+
+/**
+ * Queues a prepared buffer for upload. The buffer must be neither
+ * modified, rendered nor deleted while its uploading flag is set.
+ *
+ * @param  self    an upload queue
+ * @param  buffer  a vertex buffer
+ */
+  void
+  upload_queue_push( upload_queue_t * self,
+                     vertex_buffer_t * buffer );
+
+
+/**
+ * Switches the buffers whose upload has completed to their new GL buffers,
+ * without waiting for the others. To be called from the rendering thread,
+ * typically once per frame.
+ *
+ * @param  self  an upload queue
+ * @return       number of buffers switched
+ */
+  size_t
+  upload_queue_poll( upload_queue_t * self );
+
+
+/**
+ * Returns the number of buffers queued and not switched yet.
+ *
+ * @param  self  an upload queue
+ * @return       number of buffers
+ */
+  size_t
+  upload_queue_size( upload_queue_t * self );
+
+/** @} */
+
+#endif /* __UPLOAD_QUEUE_H__ */
@@ -30,44 +30,198 @@
 // those of the authors and should not be interpreted as representing official
 // policies, either expressed or implied, of Nicolas P. Rougier.
 // ----------------------------------------------------------------------------
+#if defined(__linux__)
+    #define _GNU_SOURCE
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define VECTOR_MMAP
+#endif
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include "vector.h"
 
+// Global counters are shared by vectors used from several threads
+#if defined(__GNUC__)
+    #define VECTOR_ATOMIC_ADD( counter, value ) \
+        __sync_add_and_fetch( &(counter), (value) )
+#else
+    #define VECTOR_ATOMIC_ADD( counter, value ) ((counter) += (value))
+#endif
+
+
+// Size (in bytes) from which items are mapped, 0 to never map them
+static size_t vector_mmap_threshold = 64*1024*1024;
+
+// Whether mapped items are advised to use transparent huge pages
+static int vector_huge_pages = 0;
+
+// Memory counters of all vectors
+static vector_stats_t vector_stats = { 0, 0, 0, 0, 0, 0, 0 };
+
+
+
+// --------------------------------------------------------- vector_account ---
+void
+vector_account( vector_t *self, int allocation, size_t copied )
+{
+    size_t bytes = self->capacity * self->item_size;
+    size_t total;
+
+    if( allocation )
+    {
+        self->stats.allocations++;
+        VECTOR_ATOMIC_ADD( vector_stats.allocations, 1 );
+    }
+    else
+    {
+        self->stats.reallocations++;
+        VECTOR_ATOMIC_ADD( vector_stats.reallocations, 1 );
+    }
+    self->stats.bytes_copied += copied;
+    VECTOR_ATOMIC_ADD( vector_stats.bytes_copied, copied );
+
+    // Sizes being unsigned, shrinking wraps around to a subtraction
+    total = VECTOR_ATOMIC_ADD( vector_stats.bytes,
+                               bytes - self->stats.bytes );
+    self->stats.bytes = bytes;
+    if( bytes > self->stats.peak_bytes )
+    {
+        self->stats.peak_bytes = bytes;
+    }
+    if( total > vector_stats.peak_bytes )
+    {
+        vector_stats.peak_bytes = total;
+    }
+}
+
 
 
 // ------------------------------------------------------------- vector_new ---
 vector_t *
 vector_new( size_t item_size )
+{
+    return vector_new_with_allocator( item_size, 0 );
+}
+
+
+
+// ---------------------------------------------- vector_new_with_allocator ---
+vector_t *
+vector_new_with_allocator( size_t item_size,
+                           const allocator_t * allocator )
 {
     assert( item_size );
 
-    vector_t *self = (vector_t *) malloc( sizeof(vector_t) );
-    if( !self )
-    {
-        fprintf( stderr,
-                 "line %d: No more memory for allocating data\n", __LINE__ );
-        exit( EXIT_FAILURE );
-    }
+    vector_t *self = (vector_t *) allocator_alloc( allocator,
+                                                   sizeof(vector_t) );
     self->item_size = item_size;
     self->size      = 0;
     self->capacity  = 1;
-    self->items     = malloc( self->item_size * self->capacity );
+    self->allocator = allocator;
+    self->items     = allocator_alloc( allocator,
+                                       self->item_size * self->capacity );
+    self->mapped    = 0;
+    memset( &self->stats, 0, sizeof(vector_stats_t) );
+    vector_account( self, 1, 0 );
     return self;
 }
 
 
 
+// ---------------------------------------------- vector_set_mmap_threshold ---
+void
+vector_set_mmap_threshold( size_t threshold, int huge_pages )
+{
+    vector_mmap_threshold = threshold;
+    vector_huge_pages = huge_pages;
+}
+
+
+#if defined(VECTOR_MMAP)
+// -------------------------------------------------------- vector_map_size ---
+size_t
+vector_map_size( size_t bytes )
+{
+    size_t page = sysconf( _SC_PAGESIZE );
+
+    return (bytes + page - 1) / page * page;
+}
+
+
+// ----------------------------------------------------------- vector_remap ---
+void
+vector_remap( vector_t *self, size_t capacity )
+{
+    size_t length = vector_map_size( capacity * self->item_size );
+    void * items;
+
+    int mapped = self->mapped;
+
+    // Items written past size (reserve then commit) are kept, as realloc
+    // does
+    size_t copied = ( capacity < self->capacity ? capacity : self->capacity )
+                  * self->item_size;
+
+    if( mapped )
+    {
+        // Pages are moved by the kernel, never copied
+        items = mremap( self->items,
+                        vector_map_size( self->capacity * self->item_size ),
+                        length, MREMAP_MAYMOVE );
+    }
+    else
+    {
+        items = mmap( 0, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if( items != MAP_FAILED )
+        {
+            memcpy( items, self->items, copied );
+            allocator_free( self->allocator, self->items,
+                            self->capacity * self->item_size );
+        }
+    }
+    if( items == MAP_FAILED )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+#if defined(MADV_HUGEPAGE)
+    if( vector_huge_pages )
+    {
+        madvise( items, length, MADV_HUGEPAGE );
+    }
+#endif
+    self->items = items;
+    self->capacity = capacity;
+    self->mapped = 1;
+    vector_account( self, !mapped, mapped ? 0 : copied );
+}
+#endif
+
+
 // ---------------------------------------------------------- vector_delete ---
 void
 vector_delete( vector_t *self )
 {
     assert( self );
 
-    free( self->items );
-    free( self );
+#if defined(VECTOR_MMAP)
+    if( self->mapped )
+    {
+        munmap( self->items,
+                vector_map_size( self->capacity * self->item_size ) );
+        self->items = 0;
+    }
+#endif
+    allocator_free( self->allocator, self->items,
+                    self->capacity * self->item_size );
+    VECTOR_ATOMIC_ADD( vector_stats.bytes, -self->stats.bytes );
+    VECTOR_ATOMIC_ADD( vector_stats.frees, 1 );
+    allocator_free( self->allocator, self, sizeof(vector_t) );
 }
 
 
@@ -157,8 +311,22 @@ vector_reserve( vector_t *self,
 
     if( self->capacity < size)
     {
-        self->items = realloc( self->items, size * self->item_size );
+#if defined(VECTOR_MMAP)
+        size_t bytes = size * self->item_size;
+        if( self->mapped || (!self->allocator && vector_mmap_threshold &&
+                             (bytes >= vector_mmap_threshold)) )
+        {
+            vector_remap( self, size );
+            return;
+        }
+#endif
+        uintptr_t items = (uintptr_t) self->items;
+        size_t copied = self->capacity * self->item_size;
+        self->items = allocator_realloc( self->allocator, self->items,
+                                         copied, size * self->item_size );
         self->capacity = size;
+        vector_account( self, 0, ((uintptr_t) self->items != items)
+                                 ? copied : 0 );
     }
 }
 
@@ -179,11 +347,61 @@ vector_shrink( vector_t *self )
 {
     assert( self );
 
-    if( self->capacity > self->size )
+    vector_shrink_to( self, self->size );
+}
+
+
+
+// ------------------------------------------------------- vector_shrink_to ---
+void
+vector_shrink_to( vector_t *self,
+                  size_t capacity )
+{
+    assert( self );
+
+    // At least one item is kept such that the vector can grow again
+    if( capacity < self->size )
     {
-        self->items = realloc( self->items, self->size * self->item_size );
+        capacity = self->size;
     }
-    self->capacity = self->size;
+    if( capacity < 1 )
+    {
+        capacity = 1;
+    }
+    if( capacity >= self->capacity )
+    {
+        return;
+    }
+
+#if defined(VECTOR_MMAP)
+    if( self->mapped )
+    {
+        size_t bytes = capacity * self->item_size;
+        if( vector_mmap_threshold && (bytes >= vector_mmap_threshold) )
+        {
+            vector_remap( self, capacity );
+            return;
+        }
+
+        // Back to the heap
+        void * items = allocator_alloc( 0, bytes );
+        memcpy( items, self->items, self->size * self->item_size );
+        munmap( self->items,
+                vector_map_size( self->capacity * self->item_size ) );
+        self->items = items;
+        self->capacity = capacity;
+        self->mapped = 0;
+        vector_account( self, 1, self->size * self->item_size );
+        return;
+    }
+#endif
+    uintptr_t items = (uintptr_t) self->items;
+    self->items = allocator_realloc( self->allocator, self->items,
+                                     self->capacity * self->item_size,
+                                     capacity * self->item_size );
+    self->capacity = capacity;
+    vector_account( self, 0, ((uintptr_t) self->items != items)
+                             ? capacity * self->item_size : 0 );
 }
 
 
@@ -360,3 +578,43 @@ vector_sort( vector_t *self,
 
     qsort(self->items, self->size, self->item_size, cmp);
 }
+
+
+
+// ------------------------------------------------------- vector_get_stats ---
+void
+vector_get_stats( const vector_t *self,
+                  vector_stats_t *stats )
+{
+    assert( stats );
+
+    if( !self )
+    {
+        *stats = vector_stats;
+        return;
+    }
+    *stats = self->stats;
+    stats->slack_bytes = (self->capacity - self->size) * self->item_size;
+}
+
+
+
+// ----------------------------------------------------- vector_print_stats ---
+void
+vector_print_stats( FILE * stream,
+                    const vector_stats_t *stats,
+                    int json )
+{
+    assert( stream );
+    assert( stats );
+
+    fprintf( stream, json
+             ? "{\"allocations\": %zu, \"reallocations\": %zu, "
+               "\"frees\": %zu, \"bytes_copied\": %zu, \"bytes\": %zu, "
+               "\"peak_bytes\": %zu, \"slack_bytes\": %zu}"
+             : "allocations %zu, reallocations %zu, frees %zu, "
+               "bytes copied %zu, bytes %zu, peak %zu, slack %zu",
+             stats->allocations, stats->reallocations, stats->frees,
+             stats->bytes_copied, stats->bytes, stats->peak_bytes,
+             stats->slack_bytes );
+}
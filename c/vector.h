@@ -33,6 +33,9 @@
 #ifndef __VECTOR_H__
 #define __VECTOR_H__
 #include <stddef.h>
+#include <stdio.h>
+
+#include "allocator.h"
 
 /**
  * @file   vector.h
@@ -64,6 +67,34 @@
  * @{
  */
 
+/**
+ * Memory counters of a vector, or of all vectors (see vector_get_stats).
+ */
+typedef struct
+{
+    /** Number of allocations of items. */
+    size_t allocations;
+
+    /** Number of reallocations of items (growing or shrinking). */
+    size_t reallocations;
+
+    /** Number of deleted vectors (global counters only). */
+    size_t frees;
+
+    /** Number of bytes copied by reallocations that moved the items. */
+    size_t bytes_copied;
+
+    /** Number of bytes allocated for items. */
+    size_t bytes;
+
+    /** Peak number of bytes allocated for items. */
+    size_t peak_bytes;
+
+    /** Number of allocated bytes beyond size (per vector counters only). */
+    size_t slack_bytes;
+} vector_stats_t;
+
+
 /**
  *  Generic vector structure.
  *
@@ -82,6 +113,15 @@ typedef struct
 
      /** Size (in bytes) of a single item. */
      size_t item_size;
+
+     /** Whether items are mapped (see vector_set_mmap_threshold). */
+     int mapped;
+
+     /** Allocator of the items (0 for the system one). */
+     const allocator_t * allocator;
+
+     /** Memory counters (see vector_get_stats). */
+     vector_stats_t stats;
 } vector_t;
 
 
@@ -96,6 +136,31 @@ typedef struct
   vector_new( size_t item_size );
 
 
+/**
+ * Creates a new empty vector whose memory comes from an allocator.
+ *
+ * @param   item_size    item size in bytes
+ * @param   allocator    an allocator (0 for the system one)
+ * @return               a new empty vector
+ */
+  vector_t *
+  vector_new_with_allocator( size_t item_size,
+                             const allocator_t * allocator );
+
+
+/**
+ * Sets the size from which vectors items are allocated with mmap and
+ * grown with mremap (Linux only), pages being then moved by the kernel
+ * instead of copied. Defaults to 64 MB.
+ *
+ * @param  threshold   size in bytes, 0 to never map items
+ * @param  huge_pages  whether mapped items are advised to use transparent
+ *                     huge pages
+ */
+  void
+  vector_set_mmap_threshold( size_t threshold, int huge_pages );
+
+
 /**
  *  Deletes a vector.
  *
@@ -202,6 +267,17 @@ typedef struct
   vector_shrink( vector_t *self );
 
 
+/**
+ *  Decrease capacity to a given number of items (and no less than size).
+ *
+ *  @param  self      a vector structure
+ *  @param  capacity  capacity to shrink to
+ */
+  void
+  vector_shrink_to( vector_t *self,
+                    size_t capacity );
+
+
 /**
  *  Removes all items.
  *
@@ -335,6 +411,32 @@ typedef struct
                int (*cmp)(const void *, const void *) );
 
 
+/**
+ * Get the memory counters of a vector, or the global counters of all
+ * vectors (allocated bytes being then those of live vectors).
+ *
+ * @param  self   a vector structure, 0 for the global counters
+ * @param  stats  counters to fill
+ */
+  void
+  vector_get_stats( const vector_t *self,
+                    vector_stats_t *stats );
+
+
+/**
+ * Print memory counters as a single line of text or as a JSON object (no
+ * newline is appended).
+ *
+ * @param  stream  output stream
+ * @param  stats   counters to print
+ * @param  json    whether to print a JSON object
+ */
+  void
+  vector_print_stats( FILE * stream,
+                      const vector_stats_t *stats,
+                      int json );
+
+
 /** @} */
 
 #endif /* __VECTOR_H__ */
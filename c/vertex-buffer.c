@@ -34,24 +34,77 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
 #include "vec234.h"
 #include "vertex-buffer.h"
 
+#define max(a,b) ( (a)>(b) ? (a) : (b) )
+#define min(a,b) ( (a)<(b) ? (a) : (b) )
+
+#define VERTEX_BUFFER_FILE_MAGIC "GLAGG-VB"
+#define VERTEX_BUFFER_FILE_ALIGN 64
+
+/*
+ * Header of a vertex buffer file, followed by the format string and the
+ * vertices, indices, items, capacities and order sections (at the given
+ * offsets, aligned on VERTEX_BUFFER_FILE_ALIGN bytes).
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version, primitive;
+    uint64_t hash, size;
+    uint64_t format_size, vertex_size;
+    uint64_t vertex_count, index_count, item_count, order_count;
+    int64_t free_item;
+    uint64_t live_vertices, live_indices;
+    uint64_t compact_read, compact_write, compact_vertex, compact_index;
+    uint64_t vertices, indices, items, capacities, order;
+} vertex_buffer_file_t;
+
+/*
+ * Registry of the format descriptors, indexed by format identifier minus
+ * one. Descriptors are allocated once and never moved nor freed, so that
+ * they can be read without the lock.
+ */
+static vector_t * vertex_formats = 0;
+static pthread_mutex_t vertex_formats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Index buffer shared by the buffers storing quads and its capacity (in
+ * quads), see vertex_buffer_quad_indices.
+ */
+static GLuint vertex_buffer_quads_id = 0;
+static size_t vertex_buffer_quads = 0;
+
+
+
 // ----------------------------------------------------------------------------
-vertex_buffer_t *
-vertex_buffer_new( const char *format )
+vertex_format_t *
+vertex_format_parse( const char * format, int id )
 {
     size_t i, index = 0, stride = 0;
     const char *start = 0, *end = 0;
     GLchar *pointer = 0;
 
-    vertex_buffer_t *self = (vertex_buffer_t *) malloc (sizeof(vertex_buffer_t));
+    vertex_format_t *self =
+        (vertex_format_t *) malloc( sizeof(vertex_format_t) );
     if( !self )
     {
-        return NULL;
+        fprintf( stderr, "line %d: No more memory for allocating data\n",
+                 __LINE__ );
+        exit( EXIT_FAILURE );
     }
-
+    self->id = id;
     self->format = strdup( format );
+    self->hash = vertex_buffer_hash( format, strlen( format ),
+                                     VERTEX_BUFFER_HASH_SEED );
+    self->mask = self->generic_mask = 0;
 
     for( i=0; i<MAX_VERTEX_ATTRIBUTE; ++i )
     {
@@ -77,6 +130,14 @@ vertex_buffer_new( const char *format )
         attribute->pointer = pointer;
         stride  += attribute->size*GL_TYPE_SIZE( attribute->type );
         pointer += attribute->size*GL_TYPE_SIZE( attribute->type );
+        if( attribute->ctarget == 'g' )
+        {
+            self->generic_mask |= 1u << index;
+        }
+        else
+        {
+            self->mask |= vertex_attribute_bit( attribute->ctarget );
+        }
         self->attributes[index] = attribute;
         index++;
     } while ( end && (index < MAX_VERTEX_ATTRIBUTE) );
@@ -85,14 +146,207 @@ vertex_buffer_new( const char *format )
     {
         self->attributes[i]->stride = stride;
     }
+    self->n_attributes = index;
+    self->stride = stride;
+    return self;
+}
+
+
+
+// ----------------------------------------------------------------------------
+const vertex_format_t *
+vertex_format_intern( const char * format, uint64_t hash )
+{
+    size_t i;
+    vertex_format_t * descriptor;
+
+    for( i=0; i<vertex_formats->size; ++i )
+    {
+        descriptor = *(vertex_format_t **) vector_get( vertex_formats, i );
+        if( (descriptor->hash == hash) &&
+            (strcmp( descriptor->format, format ) == 0) )
+        {
+            return descriptor;
+        }
+    }
+    descriptor = vertex_format_parse( format, vertex_formats->size + 1 );
+    vector_push_back( vertex_formats, &descriptor );
+    return descriptor;
+}
+
+
+
+// ----------------------------------------------------------------------------
+const vertex_format_t *
+vertex_format_get( const char * format )
+{
+    const vertex_format_t * descriptor;
+    uint64_t hash;
+
+    assert( format );
+
+    hash = vertex_buffer_hash( format, strlen( format ),
+                               VERTEX_BUFFER_HASH_SEED );
+    pthread_mutex_lock( &vertex_formats_lock );
+    if( !vertex_formats )
+    {
+        // Library formats get the fixed identifiers
+        vertex_formats = vector_new( sizeof(vertex_format_t *) );
+        vertex_format_intern( "v3f:c4f:t3f",
+                              vertex_buffer_hash( "v3f:c4f:t3f", 11,
+                                                  VERTEX_BUFFER_HASH_SEED ) );
+        vertex_format_intern( "v3f:c4f:t4f",
+                              vertex_buffer_hash( "v3f:c4f:t4f", 11,
+                                                  VERTEX_BUFFER_HASH_SEED ) );
+    }
+    descriptor = vertex_format_intern( format, hash );
+    pthread_mutex_unlock( &vertex_formats_lock );
+    return descriptor;
+}
+
+
+
+// ----------------------------------------------------------------------------
+const vertex_format_t *
+vertex_format_from_id( int id )
+{
+    const vertex_format_t * descriptor = 0;
+
+    pthread_mutex_lock( &vertex_formats_lock );
+    if( vertex_formats && (id > 0) && ((size_t) id <= vertex_formats->size) )
+    {
+        descriptor = *(vertex_format_t **) vector_get( vertex_formats,
+                                                       id - 1 );
+    }
+    pthread_mutex_unlock( &vertex_formats_lock );
+    return descriptor;
+}
+
+
+
+// ----------------------------------------------------------------------------
+unsigned int
+vertex_attribute_bit( char ctarget )
+{
+    const char * p = strchr( "vcntfse", ctarget );
+
+    if( !ctarget || !p )
+    {
+        return 0;
+    }
+    return 1u << (p - "vcntfse");
+}
+
+
+
+// ----------------------------------------------------------------------------
+unsigned int
+vertex_attribute_mask( const char * what )
+{
+    unsigned int mask = 0;
+
+    assert( what );
+
+    for( ; *what; ++what )
+    {
+        mask |= vertex_attribute_bit( *what );
+    }
+    return mask;
+}
+
+
+
+// ----------------------------------------------------------------------------
+vertex_buffer_t *
+vertex_buffer_new( const char *format )
+{
+    return vertex_buffer_new_with_allocator( format, 0 );
+}
+
+
+
+// ----------------------------------------------------------------------------
+vertex_buffer_t *
+vertex_buffer_new_with_allocator( const char *format,
+                                  const allocator_t *allocator )
+{
+    size_t i;
+
+    vertex_buffer_t *self = (vertex_buffer_t *) malloc (sizeof(vertex_buffer_t));
+    if( !self )
+    {
+        return NULL;
+    }
+
+    self->descriptor = vertex_format_get( format );
+    self->format = self->descriptor->format;
+    for( i=0; i<MAX_VERTEX_ATTRIBUTE; ++i )
+    {
+        self->attributes[i] = self->descriptor->attributes[i];
+    }
+
+    self->vertices = vector_new_with_allocator( self->descriptor->stride,
+                                                allocator );
 
-    self->vertices = vector_new( stride );
     self->vertices_id  = 0;
-    self->indices = vector_new( sizeof(GLuint) );
+    self->indices = vector_new_with_allocator( sizeof(GLuint), allocator );
     self->indices_id  = 0;
-    self->items = vector_new( sizeof(ivec4) );
+    self->vertex_chunks = 0;
+    self->index_chunks = 0;
+    self->items = vector_new_with_allocator( sizeof(ivec4), allocator );
+    self->capacities = vector_new_with_allocator( sizeof(ivec2), allocator );
+    self->slack = 0;
+    self->free_item = -1;
+    self->order = vector_new_with_allocator( sizeof(ivec2), allocator );
+    self->live_vertices = 0;
+    self->live_indices = 0;
+    self->compact_read = self->compact_write = 0;
+    self->compact_vertex = self->compact_index = 0;
+    self->gap = self->gap_size = 0;
+    self->gap_open = 0;
+    self->gap_marks = vector_new_with_allocator( sizeof(char), allocator );
+    self->gap_items = self->gap_order = 0;
+    self->index = 0;
+    self->item_keys = vector_new_with_allocator( sizeof(size_t), allocator );
+    self->key_slots = vector_new_with_allocator( sizeof(size_t), allocator );
+    self->upload_bytes = self->full_uploads = self->gpu_allocations = 0;
+    self->mapping = 0;
+    self->mapping_size = 0;
+    self->scratch = 0;
     self->dirty = 1;
+    self->uploading = 0;
+    self->dirty_vertices = vector_new_with_allocator( sizeof(ivec2),
+                                                      allocator );
+    self->dirty_indices = vector_new_with_allocator( sizeof(ivec2),
+                                                     allocator );
+    self->gpu_vertices = self->gpu_indices = 0;
+    self->high_vertices = self->high_indices = self->high_items = 0;
+    self->capacity_decay = 0.95;
+    self->shrink_frames = 60;
+    memset( self->quiet_frames, 0, sizeof(self->quiet_frames) );
     self->mode = GL_TRIANGLES;
+    self->primitive = GL_TRIANGLES;
+    self->n_enabled = 0;
+    self->enabled_mask = ~0u;
+    return self;
+}
+
+
+
+// ----------------------------------------------------------------------------
+vertex_buffer_t *
+vertex_buffer_new_chunked( const char *format,
+                           size_t chunk_size )
+{
+    assert( chunk_size >= 3 );
+
+    vertex_buffer_t *self = vertex_buffer_new( format );
+
+    // Index chunks hold whole triangles
+    self->vertex_chunks = chunk_vector_new( self->vertices->item_size,
+                                            chunk_size );
+    self->index_chunks = chunk_vector_new( sizeof(GLuint),
+                                           chunk_size / 3 * 3 );
     return self;
 }
 
@@ -125,6 +379,16 @@ void
 vertex_buffer_delete( vertex_buffer_t *self )
 {
     assert( self );
+    assert( !self->uploading );
+
+    // Mapped vertices and indices are released with the mapping
+    if( self->mapping )
+    {
+        self->vertices->items = 0;
+        self->indices->items = 0;
+        munmap( self->mapping, self->mapping_size );
+        self->mapping = 0;
+    }
 
     vector_delete( self->vertices );
     self->vertices = 0;
@@ -141,11 +405,36 @@ vertex_buffer_delete( vertex_buffer_t *self )
         glDeleteBuffers( 1, &self->indices_id );
     }
     self->indices_id = 0;
-    if( self->format )
+    if( self->vertex_chunks )
     {
-        free( self->format );
+        chunk_vector_delete( self->vertex_chunks );
+        chunk_vector_delete( self->index_chunks );
     }
+    self->vertex_chunks = self->index_chunks = 0;
+    vector_delete( self->items );
+    self->items = 0;
+    vector_delete( self->capacities );
+    self->capacities = 0;
+    vector_delete( self->order );
+    self->order = 0;
+    vector_delete( self->gap_marks );
+    self->gap_marks = 0;
+    vector_delete( self->dirty_vertices );
+    self->dirty_vertices = 0;
+    vector_delete( self->dirty_indices );
+    self->dirty_indices = 0;
+    if( self->index )
+    {
+        spatial_index_delete( self->index );
+    }
+    self->index = 0;
+    vector_delete( self->item_keys );
+    self->item_keys = 0;
+    vector_delete( self->key_slots );
+    self->key_slots = 0;
+    // The format and attributes belong to the (shared) descriptor
     self->format = 0;
+    self->descriptor = 0;
     self->dirty = 0;
     free( self );
 }
@@ -161,13 +450,139 @@ vertex_buffer_format( const vertex_buffer_t *self )
 }
 
 
+
+// ----------------------------------------------------------------------------
+int
+vertex_buffer_format_id( const vertex_buffer_t *self )
+{
+    assert( self );
+
+    return self->descriptor->id;
+}
+
+
 // ----------------------------------------------------------------------------
 size_t
 vertex_buffer_size( const vertex_buffer_t *self )
 {
     assert( self );
 
-    return vector_size( self->items );
+    return vector_size( self->items ) - self->gap_size;
+}
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_vertex_count( const vertex_buffer_t *self )
+{
+    return self->vertex_chunks ? self->vertex_chunks->size
+                               : self->vertices->size;
+}
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_index_count( const vertex_buffer_t *self )
+{
+    return self->index_chunks ? self->index_chunks->size
+                              : self->indices->size;
+}
+
+
+// ----------------------------------------------------------------------------
+// Items never span two chunks: the vertices (indices) of an item are
+// contiguous from there.
+void *
+vertex_buffer_vertex_data( const vertex_buffer_t *self, size_t index )
+{
+    const chunk_vector_t * chunks = self->vertex_chunks;
+
+    if( !chunks )
+    {
+        return (char *) self->vertices->items
+             + index * self->vertices->item_size;
+    }
+    if( index >= chunk_vector_capacity( chunks ) )
+    {
+        return 0;
+    }
+    return (char *) chunk_vector_chunk( chunks, index / chunks->chunk_size )
+         + (index % chunks->chunk_size) * chunks->item_size;
+}
+
+
+// ----------------------------------------------------------------------------
+GLuint *
+vertex_buffer_index_data( const vertex_buffer_t *self, size_t index )
+{
+    const chunk_vector_t * chunks = self->index_chunks;
+
+    if( !chunks )
+    {
+        return (GLuint *) self->indices->items + index;
+    }
+    if( index >= chunk_vector_capacity( chunks ) )
+    {
+        return 0;
+    }
+    return (GLuint *) chunk_vector_chunk( chunks, index / chunks->chunk_size )
+         + index % chunks->chunk_size;
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_set_primitive( vertex_buffer_t *self,
+                             GLenum primitive )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( (primitive == GL_TRIANGLES) || (primitive == GL_TRIANGLE_STRIP) ||
+            (primitive == GL_QUADS) );
+    assert( vertex_buffer_index_count( self ) == 0 );
+    assert( (primitive != GL_QUADS) || !self->vertex_chunks ||
+            ((self->vertex_chunks->chunk_size % 4) == 0) );
+
+    self->primitive = primitive;
+}
+
+
+// ----------------------------------------------------------------------------
+GLuint
+vertex_buffer_quad_indices( size_t quads )
+{
+    size_t i;
+
+    if( quads <= vertex_buffer_quads )
+    {
+        return vertex_buffer_quads_id;
+    }
+
+    // Grown geometrically such that growing buffers rarely rebuild it
+    quads = max( quads, max( 2 * vertex_buffer_quads, 1024 ) );
+    GLuint * indices = (GLuint *) malloc( 6 * quads * sizeof(GLuint) );
+    if( !indices )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<quads; ++i )
+    {
+        GLuint * quad = indices + 6*i;
+        quad[0] = 4*i;   quad[1] = 4*i+1; quad[2] = 4*i+2;
+        quad[3] = 4*i;   quad[4] = 4*i+2; quad[5] = 4*i+3;
+    }
+    if( !vertex_buffer_quads_id )
+    {
+        glGenBuffers( 1, &vertex_buffer_quads_id );
+    }
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, vertex_buffer_quads_id );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, 6 * quads * sizeof(GLuint),
+                  indices, GL_STATIC_DRAW );
+    free( indices );
+    vertex_buffer_quads = quads;
+    return vertex_buffer_quads_id;
 }
 
 
@@ -180,7 +595,8 @@ vertex_buffer_print( vertex_buffer_t * self )
     int i = 0;
 
     fprintf( stderr, "%ld vertices, %ld indices\n",
-             vector_size( self->vertices ), vector_size( self->indices ) );
+             vertex_buffer_vertex_count( self ),
+             vertex_buffer_index_count( self ) );
 
     while( self->attributes[i] )
     {
@@ -231,326 +647,1705 @@ vertex_buffer_print( vertex_buffer_t * self )
 
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_upload ( vertex_buffer_t *self )
+vertex_buffer_add_stats( vector_stats_t * total, const vector_t * vector )
 {
-    if( !self->vertices_id )
-    {
-        glGenBuffers( 1, &self->vertices_id );
-    }
-    if( !self->indices_id )
-    {
-        glGenBuffers( 1, &self->indices_id );
-    }
-    glBindBuffer( GL_ARRAY_BUFFER, self->vertices_id );
-    glBufferData( GL_ARRAY_BUFFER,
-                  self->vertices->size*self->vertices->item_size,
-                  self->vertices->items, GL_DYNAMIC_DRAW );
-    glBindBuffer( GL_ARRAY_BUFFER, 0 );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
-    glBufferData( GL_ELEMENT_ARRAY_BUFFER,
-                  self->indices->size*self->indices->item_size,
-                  self->indices->items, GL_DYNAMIC_DRAW );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    vector_stats_t stats;
+
+    vector_get_stats( vector, &stats );
+    total->allocations += stats.allocations;
+    total->reallocations += stats.reallocations;
+    total->bytes_copied += stats.bytes_copied;
+    total->bytes += stats.bytes;
+    total->peak_bytes += stats.peak_bytes;
+    total->slack_bytes += stats.slack_bytes;
 }
 
 
-
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_clear( vertex_buffer_t *self )
+vertex_buffer_add_chunk_stats( vector_stats_t * total,
+                               const chunk_vector_t * chunks )
 {
-    assert( self );
-
-    vector_clear( self->indices );
-    vector_clear( self->vertices );
-    self->dirty = 1;
+    size_t n = chunks->chunks->size;
+    size_t bytes = n * chunks->chunk_size * chunks->item_size;
+
+    vertex_buffer_add_stats( total, chunks->chunks );
+    total->allocations += n;
+    total->bytes += bytes;
+    total->peak_bytes += bytes;
+    total->slack_bytes += bytes - chunks->size * chunks->item_size;
 }
 
 
-
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_render_setup ( vertex_buffer_t *self,
-                             GLenum mode, const char *what )
+vertex_buffer_get_stats( const vertex_buffer_t * self,
+                         vertex_buffer_stats_t * stats )
 {
-    if( self->dirty )
+    assert( self );
+    assert( stats );
+
+    const vector_t * vectors[] = { self->vertices, self->indices,
+                                   self->items, self->capacities,
+                                   self->order, self->gap_marks,
+                                   self->dirty_vertices,
+                                   self->dirty_indices };
+    size_t i, n = sizeof(vectors) / sizeof(vectors[0]);
+
+    memset( stats, 0, sizeof(vertex_buffer_stats_t) );
+    for( i=0; i<n; ++i )
     {
-        vertex_buffer_upload( self );
-        self->dirty = 0;
+        vertex_buffer_add_stats( &stats->cpu, vectors[i] );
     }
-    
-    glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
-    glBindBuffer( GL_ARRAY_BUFFER, self->vertices_id );
-
-    size_t i;
-    for( i=0; i<MAX_VERTEX_ATTRIBUTE; ++i )
+    if( self->vertex_chunks )
     {
-        vertex_attribute_t *attribute = self->attributes[i];
-        if ( attribute == 0 )
-        {
-            break;
-        }
-        else
-        {
-            if (attribute->ctarget == 'g')
-            {
-                (*(attribute->enable))( attribute );
-            }
-            else if ( strchr(what, attribute->ctarget) )
-            {
-                (*(attribute->enable))( attribute );
-            }
-        }
+        vertex_buffer_add_chunk_stats( &stats->cpu, self->vertex_chunks );
+        vertex_buffer_add_chunk_stats( &stats->cpu, self->index_chunks );
     }
-    if( self->indices->size )
+    if( self->index )
     {
-        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
+        vertex_buffer_add_stats( &stats->cpu, self->index->cells );
+        vertex_buffer_add_stats( &stats->cpu, self->index->entries );
+        vertex_buffer_add_stats( &stats->cpu, self->index->large );
+        vertex_buffer_add_stats( &stats->cpu, self->index->bounds );
+        vertex_buffer_add_stats( &stats->cpu, self->index->stamps );
     }
-    self->mode = mode;
+
+    stats->items = vertex_buffer_size( self );
+    stats->vertices = vertex_buffer_vertex_count( self );
+    stats->indices = vertex_buffer_index_count( self );
+    stats->hole_bytes =
+        (stats->vertices - min( self->live_vertices, stats->vertices ))
+        * self->vertices->item_size +
+        (stats->indices - min( self->live_indices, stats->indices ))
+        * sizeof(GLuint);
+    stats->gpu_bytes = self->gpu_vertices * self->vertices->item_size +
+                       self->gpu_indices * sizeof(GLuint);
+    stats->upload_bytes = self->upload_bytes;
+    stats->full_uploads = self->full_uploads;
+    stats->gpu_allocations = self->gpu_allocations;
 }
 
+
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_render_finish ( vertex_buffer_t *self )
+vertex_buffer_reset_stats( vertex_buffer_t * self )
 {
-    glBindBuffer( GL_ARRAY_BUFFER, 0 );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
-    glPopClientAttrib( );
+    assert( self );
+
+    self->upload_bytes = 0;
+    self->full_uploads = 0;
+    self->gpu_allocations = 0;
 }
 
 
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_render_item ( vertex_buffer_t *self,
-                            size_t index )
-{ 
+vertex_buffer_print_stats( const vertex_buffer_t * self,
+                           FILE * stream, int json )
+{
     assert( self );
-    assert( index < vector_size( self->items ) );
+    assert( stream );
+
+    vertex_buffer_stats_t stats;
+    vertex_buffer_get_stats( self, &stats );
+
+    fprintf( stream, json
+             ? "{\"items\": %zu, \"vertices\": %zu, \"indices\": %zu, "
+               "\"cpu\": "
+             : "%zu items, %zu vertices, %zu indices; cpu: ",
+             stats.items, stats.vertices, stats.indices );
+    vector_print_stats( stream, &stats.cpu, json );
+    fprintf( stream, json
+             ? ", \"hole_bytes\": %zu, \"gpu_bytes\": %zu, "
+               "\"upload_bytes\": %zu, \"full_uploads\": %zu, "
+               "\"gpu_allocations\": %zu}\n"
+             : "; holes %zu, gpu %zu, uploaded %zu (%zu full uploads, "
+               "%zu allocations)\n",
+             stats.hole_bytes, stats.gpu_bytes, stats.upload_bytes,
+             stats.full_uploads, stats.gpu_allocations );
+}
 
-    ivec4 * item = vector_get( self->items, index );
 
-    if( self->indices->size )
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_sub_data( GLenum target,
+                        const vector_t * data, const chunk_vector_t * chunks,
+                        size_t first, size_t last )
+{
+    size_t size = data->item_size, bytes = (last - first) * size;
+
+    if( !chunks )
     {
-        size_t start = item->istart;
-        size_t count = item->icount;
-        glDrawElements( self->mode, count, GL_UNSIGNED_INT, (void *)(start*sizeof(GLuint)) );
+        glBufferSubData( target, first * size, bytes,
+                         (const char *) data->items + first * size );
+        return bytes;
     }
-    else if( self->vertices->size )
+
+    // One call per chunk
+    while( first < last )
     {
-        size_t start = item->vstart;
-        size_t count = item->vcount;
-        glDrawArrays( self->mode, start*self->vertices->item_size, count);
+        size_t offset = first % chunks->chunk_size;
+        size_t count = min( last - first, chunks->chunk_size - offset );
+        const char * items = (const char *)
+            chunk_vector_chunk( chunks, first / chunks->chunk_size );
+        glBufferSubData( target, first * size, count * size,
+                         items + offset * size );
+        first += count;
     }
+    return bytes;
 }
 
 
+
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_render ( vertex_buffer_t *self,
-                       GLenum mode, const char *what )
+vertex_buffer_gpu_capacity( const vertex_buffer_t *self,
+                            size_t * vcapacity, size_t * icapacity )
 {
-    size_t vcount = self->vertices->size;
-    size_t icount = self->indices->size;
+    *vcapacity = self->vertices->capacity;
+    *icapacity = self->indices->capacity;
 
-    vertex_buffer_render_setup( self, mode, what );
-    if( icount )
-    {
-        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
-        glDrawElements( mode, icount, GL_UNSIGNED_INT, 0 );
-    }
-    else
+    // Chunks are allocated one at a time, GPU buffers grow geometrically
+    if( self->vertex_chunks )
     {
-        glDrawArrays( mode, 0, vcount );
+        *vcapacity = chunk_vector_capacity( self->vertex_chunks );
+        *icapacity = chunk_vector_capacity( self->index_chunks );
+        *vcapacity = (*vcapacity > self->gpu_vertices)
+                   ? max( *vcapacity, 2*self->gpu_vertices )
+                   : self->gpu_vertices;
+        *icapacity = (*icapacity > self->gpu_indices)
+                   ? max( *icapacity, 2*self->gpu_indices )
+                   : self->gpu_indices;
     }
-    vertex_buffer_render_finish( self );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_upload ( vertex_buffer_t *self )
+{
+    size_t vcapacity, icapacity;
+
+    assert( !self->uploading );
+
+    if( !self->vertices_id )
+    {
+        glGenBuffers( 1, &self->vertices_id );
+    }
+    if( !self->indices_id )
+    {
+        glGenBuffers( 1, &self->indices_id );
+    }
+    vertex_buffer_gpu_capacity( self, &vcapacity, &icapacity );
+
+    // Buffers are allocated at full capacity such that items appended
+    // later on can be uploaded as ranges, the storage being reused as long
+    // as the capacity is unchanged
+    glBindBuffer( GL_ARRAY_BUFFER, self->vertices_id );
+    if( vcapacity != self->gpu_vertices )
+    {
+        glBufferData( GL_ARRAY_BUFFER,
+                      vcapacity*self->vertices->item_size,
+                      NULL, GL_DYNAMIC_DRAW );
+        self->gpu_allocations++;
+    }
+    self->upload_bytes +=
+        vertex_buffer_sub_data( GL_ARRAY_BUFFER,
+                                self->vertices, self->vertex_chunks,
+                                0, vertex_buffer_vertex_count( self ) );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
+    if( icapacity != self->gpu_indices )
+    {
+        glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+                      icapacity*self->indices->item_size,
+                      NULL, GL_DYNAMIC_DRAW );
+        self->gpu_allocations++;
+    }
+    self->upload_bytes +=
+        vertex_buffer_sub_data( GL_ELEMENT_ARRAY_BUFFER,
+                                self->indices, self->index_chunks,
+                                0, vertex_buffer_index_count( self ) );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    self->gpu_vertices = vcapacity;
+    self->gpu_indices = icapacity;
+    self->full_uploads++;
+    vector_clear( self->dirty_vertices );
+    vector_clear( self->dirty_indices );
+}
+
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_upload_copy( const vertex_buffer_t *self,
+                           GLuint vertices_id, GLuint indices_id )
+{
+    size_t vcapacity, icapacity, bytes = 0;
+
+    assert( self );
+    assert( vertices_id && indices_id );
+
+    vertex_buffer_gpu_capacity( self, &vcapacity, &icapacity );
+    glBindBuffer( GL_ARRAY_BUFFER, vertices_id );
+    glBufferData( GL_ARRAY_BUFFER, vcapacity*self->vertices->item_size,
+                  NULL, GL_DYNAMIC_DRAW );
+    bytes += vertex_buffer_sub_data( GL_ARRAY_BUFFER,
+                                     self->vertices, self->vertex_chunks,
+                                     0, vertex_buffer_vertex_count( self ) );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indices_id );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, icapacity*self->indices->item_size,
+                  NULL, GL_DYNAMIC_DRAW );
+    bytes += vertex_buffer_sub_data( GL_ELEMENT_ARRAY_BUFFER,
+                                     self->indices, self->index_chunks,
+                                     0, vertex_buffer_index_count( self ) );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    return bytes;
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_swap_gpu_buffers( vertex_buffer_t *self,
+                                GLuint vertices_id, GLuint indices_id )
+{
+    size_t vcapacity, icapacity;
+
+    assert( self );
+
+    vertex_buffer_gpu_capacity( self, &vcapacity, &icapacity );
+    if( self->vertices_id )
+    {
+        glDeleteBuffers( 1, &self->vertices_id );
+    }
+    if( self->indices_id )
+    {
+        glDeleteBuffers( 1, &self->indices_id );
+    }
+    self->vertices_id = vertices_id;
+    self->indices_id = indices_id;
+    self->gpu_vertices = vcapacity;
+    self->gpu_indices = icapacity;
+    self->upload_bytes +=
+        vertex_buffer_vertex_count( self ) * self->vertices->item_size +
+        vertex_buffer_index_count( self ) * sizeof(GLuint);
+    self->full_uploads++;
+    self->gpu_allocations += 2;
+    vector_clear( self->dirty_vertices );
+    vector_clear( self->dirty_indices );
+    self->dirty = 0;
+}
+
+
+
+// ----------------------------------------------------------------------------
+int
+vertex_buffer_range_compare( const void * a, const void * b )
+{
+    return ((const ivec2 *) a)->x - ((const ivec2 *) b)->x;
+}
+
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_upload_ranges( GLenum target, GLuint id,
+                             const vector_t * data,
+                             const chunk_vector_t * chunks,
+                             vector_t * ranges )
+{
+    ivec2 * R = (ivec2 *) ranges->items;
+    size_t n = ranges->size, i, j, bytes = 0;
+
+    if( !n )
+    {
+        return 0;
+    }
+
+    // Overlapping or adjacent ranges are coalesced
+    qsort( R, n, sizeof(ivec2), vertex_buffer_range_compare );
+    for( i=0, j=1; j<n; ++j )
+    {
+        if( R[j].x <= R[i].y )
+        {
+            R[i].y = max( R[i].y, R[j].y );
+        }
+        else
+        {
+            R[++i] = R[j];
+        }
+    }
+    n = i+1;
+
+    glBindBuffer( target, id );
+    for( i=0; i<n; ++i )
+    {
+        bytes += vertex_buffer_sub_data( target, data, chunks,
+                                         R[i].x, R[i].y );
+    }
+    glBindBuffer( target, 0 );
+    vector_clear( ranges );
+    return bytes;
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_touch( vertex_buffer_t * self,
+                     size_t vfirst, size_t vlast,
+                     size_t ifirst, size_t ilast )
+{
+    if( self->dirty )
+    {
+        return;
+    }
+
+    // Ranges beyond GPU capacity require the buffers to be reallocated
+    if( (vlast > self->gpu_vertices) || (ilast > self->gpu_indices) )
+    {
+        vector_clear( self->dirty_vertices );
+        vector_clear( self->dirty_indices );
+        self->dirty = 1;
+        return;
+    }
+    if( vfirst < vlast )
+    {
+        ivec2 range = {{ vfirst, vlast }};
+        ivec2_vector_push_back( self->dirty_vertices, range );
+    }
+    if( ifirst < ilast )
+    {
+        ivec2 range = {{ ifirst, ilast }};
+        ivec2_vector_push_back( self->dirty_indices, range );
+    }
+}
+
+
+
+// ----------------------------------------------------------------------------
+int
+vertex_buffer_shrink_capacity( vector_t * vector, double high, int shrink )
+{
+    size_t capacity = (size_t) high + 1;
+
+    if( 2*capacity >= vector->capacity )
+    {
+        return 0;
+    }
+    if( shrink )
+    {
+        vector_shrink_to( vector, capacity );
+    }
+    return 1;
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_end_frame( vertex_buffer_t * self )
+{
+    float decay = self->capacity_decay;
+    size_t i;
+
+    self->high_vertices = max( vertex_buffer_vertex_count( self ),
+                               self->high_vertices * decay );
+    self->high_indices = max( vertex_buffer_index_count( self ),
+                              self->high_indices * decay );
+    self->high_items = max( vertex_buffer_size( self ),
+                            self->high_items * decay );
+
+    // Chunks are kept as they are, mapped vertices are not shrunk
+    if( !self->shrink_frames || self->vertex_chunks || self->mapping )
+    {
+        return;
+    }
+
+    // A frame is quiet for a vector when its high-water mark fits in half
+    // its capacity
+    vector_t * vectors[5] = { self->vertices, self->indices, self->items,
+                              self->capacities, self->order };
+    double highs[5] = { self->high_vertices, self->high_indices,
+                        self->high_items, self->high_items,
+                        self->high_items };
+    int shrink = 0;
+    for( i=0; i<5; ++i )
+    {
+        if( vertex_buffer_shrink_capacity( vectors[i], highs[i], 0 ) )
+        {
+            self->quiet_frames[i]++;
+        }
+        else
+        {
+            self->quiet_frames[i] = 0;
+        }
+        shrink |= (self->quiet_frames[i] >= self->shrink_frames);
+    }
+    if( !shrink )
+    {
+        return;
+    }
+    vertex_buffer_close_gap( self );
+    for( i=0; i<5; ++i )
+    {
+        if( self->quiet_frames[i] >= self->shrink_frames )
+        {
+            vertex_buffer_shrink_capacity( vectors[i], highs[i], 1 );
+            self->quiet_frames[i] = 0;
+        }
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_clear( vertex_buffer_t *self )
+{
+    assert( self );
+    assert( !self->uploading );
+
+    vertex_buffer_end_frame( self );
+    vector_clear( self->indices );
+    vector_clear( self->vertices );
+    if( self->vertex_chunks )
+    {
+        chunk_vector_clear( self->vertex_chunks );
+        chunk_vector_clear( self->index_chunks );
+    }
+    vector_clear( self->items );
+    vector_clear( self->capacities );
+    vector_clear( self->order );
+    vector_clear( self->gap_marks );
+    self->gap = self->gap_size = 0;
+    self->gap_open = 0;
+    vector_clear( self->dirty_vertices );
+    vector_clear( self->dirty_indices );
+    self->free_item = -1;
+    self->live_vertices = 0;
+    self->live_indices = 0;
+    self->compact_read = self->compact_write = 0;
+    self->compact_vertex = self->compact_index = 0;
+    if( self->index )
+    {
+        spatial_index_clear( self->index );
+    }
+    vector_clear( self->item_keys );
+    vector_clear( self->key_slots );
+    self->dirty = 1;
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_setup ( vertex_buffer_t *self,
+                             GLenum mode, const char *what )
+{
+    vertex_buffer_render_setup_mask( self, mode,
+                                     vertex_attribute_mask( what ) );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_setup_mask ( vertex_buffer_t *self,
+                                  GLenum mode, unsigned int mask )
+{
+    size_t i;
+
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    if( self->dirty )
+    {
+        vertex_buffer_upload( self );
+        self->dirty = 0;
+    }
+    else
+    {
+        self->upload_bytes +=
+            vertex_buffer_upload_ranges( GL_ARRAY_BUFFER, self->vertices_id,
+                                         self->vertices, self->vertex_chunks,
+                                         self->dirty_vertices );
+        self->upload_bytes +=
+            vertex_buffer_upload_ranges( GL_ELEMENT_ARRAY_BUFFER,
+                                         self->indices_id,
+                                         self->indices, self->index_chunks,
+                                         self->dirty_indices );
+    }
+
+    glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+    glBindBuffer( GL_ARRAY_BUFFER, self->vertices_id );
+
+    // Enable sequence is computed again only when the mask changes
+    mask &= self->descriptor->mask;
+    if( mask != self->enabled_mask )
+    {
+        self->n_enabled = 0;
+        for( i=0; i<self->descriptor->n_attributes; ++i )
+        {
+            vertex_attribute_t *attribute = self->attributes[i];
+            if( (attribute->ctarget == 'g') ||
+                (mask & vertex_attribute_bit( attribute->ctarget )) )
+            {
+                self->enabled[self->n_enabled++] = attribute;
+            }
+        }
+        self->enabled_mask = mask;
+    }
+    for( i=0; i<self->n_enabled; ++i )
+    {
+        (*(self->enabled[i]->enable))( self->enabled[i] );
+    }
+    if( vertex_buffer_index_count( self ) )
+    {
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
+    }
+    else if( self->primitive == GL_QUADS )
+    {
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, vertex_buffer_quad_indices(
+                          vertex_buffer_vertex_count( self ) / 4 ) );
+    }
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        glEnable( GL_PRIMITIVE_RESTART );
+        glPrimitiveRestartIndex( VERTEX_BUFFER_RESTART_INDEX );
+    }
+    self->mode = mode;
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_finish ( vertex_buffer_t *self )
+{
+    if( self->primitive == GL_TRIANGLE_STRIP )
+    {
+        glDisable( GL_PRIMITIVE_RESTART );
+    }
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    glPopClientAttrib( );
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_item ( vertex_buffer_t *self,
+                            size_t index )
+{ 
+    assert( self );
+    vertex_buffer_close_gap( self );
+    assert( index < vector_size( self->items ) );
+
+    ivec4 * item = ivec4_vector_at( self->items, index );
+
+    if( item->icount < 0 )
+    {
+        return;
+    }
+    if( vertex_buffer_index_count( self ) )
+    {
+        size_t start = item->istart;
+        size_t count = item->icount;
+        glDrawElements( self->mode, count, GL_UNSIGNED_INT, (void *)(start*sizeof(GLuint)) );
+    }
+    else if( self->primitive == GL_QUADS )
+    {
+        size_t start = item->vstart / 4 * 6;
+        size_t count = item->vcount / 4 * 6;
+        glDrawElements( self->mode, count, GL_UNSIGNED_INT,
+                        (void *) (start * sizeof(GLuint)) );
+    }
+    else if( vertex_buffer_vertex_count( self ) )
+    {
+        size_t start = item->vstart;
+        size_t count = item->vcount;
+        glDrawArrays( self->mode, start*self->vertices->item_size, count);
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render ( vertex_buffer_t *self,
+                       GLenum mode, const char *what )
+{
+    vertex_buffer_render_mask( self, mode, vertex_attribute_mask( what ) );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_mask ( vertex_buffer_t *self,
+                            GLenum mode, unsigned int mask )
+{
+    size_t vcount = vertex_buffer_vertex_count( self );
+    size_t icount = vertex_buffer_index_count( self );
+
+    // Buffers being uploaded in the background are not rendered yet
+    if( self->uploading )
+    {
+        return;
+    }
+    vertex_buffer_render_setup_mask( self, mode, mask );
+    if( icount )
+    {
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, self->indices_id );
+        glDrawElements( mode, icount, GL_UNSIGNED_INT, 0 );
+    }
+    else if( self->primitive == GL_QUADS )
+    {
+        glDrawElements( mode, vcount / 4 * 6, GL_UNSIGNED_INT, 0 );
+    }
+    else
+    {
+        glDrawArrays( mode, 0, vcount );
+    }
+    vertex_buffer_render_finish( self );
 }
     
 
 
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_push_back_indices ( vertex_buffer_t * self,
-                                  GLuint * indices,
-                                  size_t icount )
+vertex_buffer_render_items ( vertex_buffer_t *self,
+                             GLenum mode, const char *what,
+                             const size_t * items, size_t count )
+{
+    vertex_buffer_render_items_mask( self, mode,
+                                     vertex_attribute_mask( what ),
+                                     items, count );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_render_items_mask ( vertex_buffer_t *self,
+                                  GLenum mode, unsigned int mask,
+                                  const size_t * items, size_t count )
+{
+    assert( self );
+    assert( items || !count );
+
+    // Buffers being uploaded in the background are not rendered yet
+    if( self->uploading )
+    {
+        return;
+    }
+    vertex_buffer_close_gap( self );
+
+    // Ranges are drawn by chunks such that no memory is allocated
+    enum { CHUNK = 256 };
+    GLsizei counts[CHUNK];
+    const GLvoid * offsets[CHUNK];
+    size_t i, n = 0;
+    int quads = (self->primitive == GL_QUADS);
+
+    if( !vertex_buffer_index_count( self ) && !quads )
+    {
+        return;
+    }
+    vertex_buffer_render_setup_mask( self, mode, mask );
+    for( i=0; i<count; ++i )
+    {
+        ivec4 item = ivec4_vector_get( self->items, items[i] );
+
+        // Quads are drawn with the shared indices of their vertices
+        if( quads && (item.icount == 0) )
+        {
+            item.istart = item.vstart / 4 * 6;
+            item.icount = item.vcount / 4 * 6;
+        }
+        if( item.icount <= 0 )
+        {
+            continue;
+        }
+        size_t start = item.istart * sizeof(GLuint);
+        if( n && (((size_t) offsets[n-1] + counts[n-1]*sizeof(GLuint))
+                  == start) )
+        {
+            counts[n-1] += item.icount;
+            continue;
+        }
+        if( n == CHUNK )
+        {
+            glMultiDrawElements( mode, counts, GL_UNSIGNED_INT, offsets, n );
+            n = 0;
+        }
+        counts[n] = item.icount;
+        offsets[n] = (const GLvoid *) start;
+        n++;
+    }
+    if( n )
+    {
+        glMultiDrawElements( mode, counts, GL_UNSIGNED_INT, offsets, n );
+    }
+    vertex_buffer_render_finish( self );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_push_back_indices ( vertex_buffer_t * self,
+                                  GLuint * indices,
+                                  size_t icount )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( !self->index_chunks );
+
+    vertex_buffer_unmap( self );
+    self->dirty = 1;
+    vector_push_back_data( self->indices, indices, icount );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_push_back_vertices ( vertex_buffer_t * self,
+                                   void * vertices,
+                                   size_t vcount )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( !self->vertex_chunks );
+
+    vertex_buffer_unmap( self );
+    self->dirty = 1;
+    vector_push_back_data( self->vertices, vertices, vcount );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_insert_indices ( vertex_buffer_t *self,
+                               size_t index,
+                               GLuint *indices,
+                               size_t count )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( self->indices );
+    assert( !self->index_chunks );
+    assert( index < self->indices->size+1 );
+
+    vertex_buffer_unmap( self );
+    self->dirty = 1;
+    vector_insert_data( self->indices, index, indices, count );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_insert_vertices ( vertex_buffer_t *self,
+                                size_t index,
+                                void *vertices,
+                                size_t count )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( self->vertices );
+    assert( !self->vertex_chunks );
+    assert( index < self->vertices->size+1 );
+
+    vertex_buffer_unmap( self );
+    self->dirty = 1;
+
+    size_t i;
+    GLuint * indices = index_vector_data( self->indices );
+    for( i=0; i<self->indices->size; ++i )
+    {
+        if( (indices[i] > index) &&
+            (indices[i] != VERTEX_BUFFER_RESTART_INDEX) )
+        {
+            indices[i] += index;
+        }
+    }
+
+    vector_insert_data( self->vertices, index, vertices, count );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_erase_indices ( vertex_buffer_t *self,
+                              size_t first,
+                              size_t last )
 {
     assert( self );
+    assert( !self->uploading );
+    assert( self->indices );
+    assert( first < self->indices->size );
+    assert( (last) <= self->indices->size );
 
     self->dirty = 1;
-    vector_push_back_data( self->indices, indices, icount );
+    vector_erase_range( self->indices, first, last );
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_erase_vertices ( vertex_buffer_t *self,
+                               size_t first,
+                               size_t last )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( self->vertices );
+    assert( first < self->vertices->size );
+    assert( last <= self->vertices->size );
+    assert( last > first );
+
+    self->dirty = 1;
+    size_t i;
+    GLuint * indices = index_vector_data( self->indices );
+    for( i=0; i<self->indices->size; ++i )
+    {
+        if( (indices[i] > first) &&
+            (indices[i] != VERTEX_BUFFER_RESTART_INDEX) )
+        {
+            indices[i] -= (last-first);
+        }
+    }
+    vector_erase_range( self->vertices, first, last );    
+}
+
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_append( vertex_buffer_t * self,
+                      void * vertices, size_t vcount,  
+                      GLuint * indices, size_t icount )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( vertices );
+    assert( indices || !icount );
+
+    void * V;
+    GLuint * I;
+    size_t i, vstart = vertex_buffer_reserve_item( self, vcount, icount,
+                                                   &V, &I );
+    memcpy( V, vertices, vcount * self->vertices->item_size );
+    for( i=0; i<icount; ++i )
+    {
+        I[i] = (indices[i] == VERTEX_BUFFER_RESTART_INDEX)
+             ? VERTEX_BUFFER_RESTART_INDEX : indices[i] + vstart;
+    }
+    return vertex_buffer_commit_item( self, vcount, icount );
+}
+
+// ----------------------------------------------------------------------------
+// Bounds of the item held by a slot of the items table
+vec4
+vertex_buffer_slot_bounds( const vertex_buffer_t * self, size_t slot )
+{
+    const ivec4 * item = ivec4_vector_at( self->items, slot );
+    vec4 bounds = {{ 0, 0, -1, -1 }};
+    size_t i;
+
+    // Position attribute
+    vertex_attribute_t * position = 0;
+    for( i=0; (i<MAX_VERTEX_ATTRIBUTE) && self->attributes[i]; ++i )
+    {
+        if( self->attributes[i]->target == GL_VERTEX_ARRAY )
+        {
+            position = self->attributes[i];
+            break;
+        }
+    }
+    if( !position || (position->type != GL_FLOAT) || (position->size < 2) ||
+        !item->vcount )
+    {
+        return bounds;
+    }
+
+    const char * data = (const char *)
+        vertex_buffer_vertex_data( self, item->vstart )
+        + (size_t) position->pointer;
+    const float * p = (const float *) data;
+    float xmin = p[0], xmax = p[0], ymin = p[1], ymax = p[1];
+    for( i=1; i<(size_t) item->vcount; ++i )
+    {
+        p = (const float *) (data + i * self->vertices->item_size);
+        if( p[0] < xmin ) xmin = p[0];
+        if( p[0] > xmax ) xmax = p[0];
+        if( p[1] < ymin ) ymin = p[1];
+        if( p[1] > ymax ) ymax = p[1];
+    }
+    bounds = (vec4) {{ xmin, ymin, xmax-xmin, ymax-ymin }};
+    return bounds;
+}
+
+
+// ----------------------------------------------------------------------------
+// Registers the item of a slot of the items table under a new key
+void
+vertex_buffer_add_key( vertex_buffer_t * self, size_t slot )
+{
+    size_t key = self->key_slots->size;
+
+    if( self->item_keys->size <= slot )
+    {
+        vector_resize( self->item_keys, slot + 1 );
+    }
+    ((size_t *) self->item_keys->items)[slot] = key;
+    vector_push_back( self->key_slots, &slot );
+    spatial_index_insert( self->index, key,
+                          vertex_buffer_slot_bounds( self, slot ) );
+}
+
+
+// ----------------------------------------------------------------------------
+// Records the slots of the items moved to [first, last) of the items table
+void
+vertex_buffer_key_slots( vertex_buffer_t * self, size_t first, size_t last )
+{
+    const size_t * keys = (const size_t *) self->item_keys->items;
+    size_t * slots = (size_t *) self->key_slots->items;
+    size_t i;
+
+    for( i=first; i<last; ++i )
+    {
+        slots[keys[i]] = i;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// Key of the item of a handle, the gap being closed
+size_t
+vertex_buffer_item_key( const vertex_buffer_t * self, size_t index )
+{
+    return ((const size_t *) self->item_keys->items)[index];
+}
+
+
+// ----------------------------------------------------------------------------
+// Slot of the items table holding the item of a key
+size_t
+vertex_buffer_key_slot( const vertex_buffer_t * self, size_t key )
+{
+    return ((const size_t *) self->key_slots->items)[key];
+}
+
+
+// ----------------------------------------------------------------------------
+// Handle of the item held by a slot of the items table
+size_t
+vertex_buffer_slot_handle( const vertex_buffer_t * self, size_t slot )
+{
+    if( self->gap_open && (slot >= self->gap + self->gap_size) )
+    {
+        return slot - self->gap_size;
+    }
+    return slot;
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_gap_move( vector_t * vector, size_t gap, size_t gap_size,
+                        size_t index )
+{
+    char * items = (char *) vector->items;
+    size_t item_size = vector->item_size;
+
+    if( index < gap )
+    {
+        memmove( items + (index + gap_size) * item_size,
+                 items + index * item_size, (gap - index) * item_size );
+    }
+    else if( index > gap )
+    {
+        memmove( items + gap * item_size,
+                 items + (gap + gap_size) * item_size,
+                 (index - gap) * item_size );
+    }
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_gap_grow( vector_t * vector, size_t gap, size_t gap_size,
+                        size_t extra )
+{
+    size_t size = vector->size, item_size = vector->item_size;
+
+    vector_resize( vector, size + extra );
+    memmove( (char *) vector->items + (gap + gap_size + extra) * item_size,
+             (char *) vector->items + (gap + gap_size) * item_size,
+             (size - gap - gap_size) * item_size );
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_move_gap( vertex_buffer_t * self, size_t index )
+{
+    assert( self );
+    assert( index <= vertex_buffer_size( self ) );
+
+    if( !self->gap_open )
+    {
+        self->gap_open = 1;
+        self->gap = index;
+        self->gap_size = 0;
+        self->gap_items = self->items->size;
+        self->gap_order = self->order->size;
+        vector_resize( self->gap_marks, self->items->size );
+        memset( self->gap_marks->items, 0, self->gap_marks->size );
+    }
+    vertex_buffer_gap_move( self->items, self->gap, self->gap_size, index );
+    vertex_buffer_gap_move( self->capacities, self->gap, self->gap_size,
+                            index );
+    vertex_buffer_gap_move( self->gap_marks, self->gap, self->gap_size,
+                            index );
+    if( self->index )
+    {
+        vertex_buffer_gap_move( self->item_keys, self->gap, self->gap_size,
+                                index );
+        if( index < self->gap )
+        {
+            vertex_buffer_key_slots( self, index + self->gap_size,
+                                     self->gap + self->gap_size );
+        }
+        else
+        {
+            vertex_buffer_key_slots( self, self->gap, index );
+        }
+    }
+    self->gap = index;
+
+    // The gap grows geometrically
+    if( !self->gap_size )
+    {
+        size_t extra = max( 16, vertex_buffer_size( self ) );
+        vertex_buffer_gap_grow( self->items, self->gap, 0, extra );
+        vertex_buffer_gap_grow( self->capacities, self->gap, 0, extra );
+        vertex_buffer_gap_grow( self->gap_marks, self->gap, 0, extra );
+        if( self->index )
+        {
+            vertex_buffer_gap_grow( self->item_keys, self->gap, 0, extra );
+            vertex_buffer_key_slots( self, self->gap + extra,
+                                     self->items->size );
+        }
+        self->gap_size = extra;
+    }
+}
+
+// ----------------------------------------------------------------------------
+int
+vertex_buffer_order_compare( const void * a, const void * b )
+{
+    const ivec2 * u = (const ivec2 *) a;
+    const ivec2 * v = (const ivec2 *) b;
+
+    if( u->y != v->y )
+    {
+        return (u->y < v->y) ? -1 : +1;
+    }
+    return (u->x < v->x) ? -1 : (u->x > v->x);
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_close_gap( vertex_buffer_t * self )
+{
+    assert( self );
+
+    // Gaps are closed by upload_queue_push, reading a buffer being uploaded
+    // closes nothing
+    if( !self->gap_open )
+    {
+        return;
+    }
+    assert( !self->uploading );
+    size_t size = vertex_buffer_size( self ), i, j = 0;
+    vertex_buffer_gap_move( self->items, self->gap, self->gap_size, size );
+    vertex_buffer_gap_move( self->capacities, self->gap, self->gap_size,
+                            size );
+    vertex_buffer_gap_move( self->gap_marks, self->gap, self->gap_size,
+                            size );
+    if( self->index )
+    {
+        vertex_buffer_gap_move( self->item_keys, self->gap, self->gap_size,
+                                size );
+        self->item_keys->size = size;
+        vertex_buffer_key_slots( self, self->gap, size );
+    }
+    self->items->size = self->capacities->size = size;
+    self->gap = self->gap_size = 0;
+    self->gap_open = 0;
+
+    // New handles of the items present when the gap was opened
+    const char * marks = (const char *) self->gap_marks->items;
+    ivec4 * items = (ivec4 *) self->items->items;
+    ivec2 * order = (ivec2 *) self->order->items;
+    vector_t * handles = vector_new_with_allocator( sizeof(int),
+                                                    self->scratch );
+    vector_resize( handles, self->gap_items );
+    int * H = (int *) handles->items;
+    for( i=0; i<size; ++i )
+    {
+        if( !marks[i] )
+        {
+            H[j++] = i;
+        }
+    }
+    assert( j == self->gap_items );
+
+    // Storage order and free slots links
+    for( i=0; i<self->gap_order; ++i )
+    {
+        order[i].x = H[order[i].x];
+    }
+    for( i=0; i<size; ++i )
+    {
+        if( !marks[i] && (items[i].icount < 0) && (items[i].vstart >= 0) )
+        {
+            items[i].vstart = H[items[i].vstart];
+        }
+    }
+    if( self->free_item >= 0 )
+    {
+        self->free_item = H[self->free_item];
+    }
+
+    // Inserted items were pushed in storage order
+    for( i=0, j=self->gap_order; i<size; ++i )
+    {
+        if( marks[i] )
+        {
+            order[j++] = (ivec2) {{ i, items[i].vstart }};
+        }
+    }
+    assert( j == self->order->size );
+    qsort( order + self->gap_order, j - self->gap_order, sizeof(ivec2),
+           vertex_buffer_order_compare );
+    vector_delete( handles );
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_insert( vertex_buffer_t * self,
+                      size_t index,
+                      void * vertices, size_t vcount,  
+                      GLuint * indices, size_t icount )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( vertices );
+    assert( indices || !icount );
+    assert( (self->primitive != GL_QUADS) ||
+            ((icount == 0) && ((vcount % 4) == 0)) );
+
+    // Push back vertices
+    size_t vstart = vector_size( self->vertices );
+    vertex_buffer_push_back_vertices( self, vertices, vcount );
+
+    // Push back indices (none in GL_QUADS mode)
+    size_t istart = vector_size( self->indices );
+    if( icount )
+    {
+        vertex_buffer_push_back_indices( self, indices, icount );
+
+        // Update indices within the vertex buffer
+        size_t i;
+        GLuint * value = index_vector_data( self->indices ) + istart;
+        for( i=0; i<icount; ++i )
+        {
+            if( value[i] != VERTEX_BUFFER_RESTART_INDEX )
+            {
+                value[i] += vstart;
+            }
+        }
+    }
+
+    // Insert item into the gap, the following handles being renumbered
+    // when the gap is closed
+    vertex_buffer_move_gap( self, index );
+    ivec4 item = {{ vstart, vcount, istart, icount }};
+    ivec2 capacity = {{ vcount, icount }};
+    ivec2 entry = {{ index, vstart }};
+    *ivec4_vector_at( self->items, self->gap ) = item;
+    *ivec2_vector_at( self->capacities, self->gap ) = capacity;
+    ((char *) self->gap_marks->items)[self->gap] = 1;
+    if( self->index )
+    {
+        vertex_buffer_add_key( self, self->gap );
+    }
+    self->gap++;
+    self->gap_size--;
+    ivec2_vector_push_back( self->order, entry );
+    self->live_vertices += vcount;
+    self->live_indices += icount;
+}
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_reserve_item( vertex_buffer_t * self,
+                            size_t vcount, size_t icount,
+                            void ** vertices, GLuint ** indices )
+{
+    assert( self );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    assert( vertices );
+    assert( indices );
+
+    if( self->vertex_chunks )
+    {
+        size_t vstart, istart;
+        *vertices = chunk_vector_reserve_contiguous( self->vertex_chunks,
+                                                     vcount, &vstart );
+        *indices = chunk_vector_reserve_contiguous( self->index_chunks,
+                                                    icount, &istart );
+        return vstart;
+    }
+    vertex_buffer_unmap( self );
+
+    vector_t * V = self->vertices;
+    vector_t * I = self->indices;
+
+    // Grow geometrically so that repeated reservations stay amortized O(1)
+    if( V->capacity < (V->size + vcount) )
+    {
+        vector_reserve( V, max( 2*V->capacity, V->size + vcount ) );
+    }
+    if( I->capacity < (I->size + icount) )
+    {
+        vector_reserve( I, max( 2*I->capacity, I->size + icount ) );
+    }
+    *vertices = (char *) V->items + V->size * V->item_size;
+    *indices  = (GLuint *) I->items + I->size;
+
+    return V->size;
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_degenerate( vertex_buffer_t * self,
+                          size_t first, size_t last )
+{
+    GLuint value = (self->primitive == GL_TRIANGLE_STRIP)
+                 ? VERTEX_BUFFER_RESTART_INDEX : 0;
+    GLuint * indices;
+    size_t i;
+
+    if( first >= last )
+    {
+        return;
+    }
+    indices = vertex_buffer_index_data( self, first );
+    for( i=0; i<last-first; ++i )
+    {
+        indices[i] = value;
+    }
+}
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_degenerate_quads( vertex_buffer_t * self,
+                                size_t first, size_t last )
+{
+    // Quads have no index to make degenerate, their vertices are zeroed
+    if( (self->primitive != GL_QUADS) || (first >= last) )
+    {
+        return;
+    }
+    memset( vertex_buffer_vertex_data( self, first ), 0,
+            (last - first) * self->vertices->item_size );
+    vertex_buffer_touch( self, first, last, 0, 0 );
+}
+
+// ----------------------------------------------------------------------------
+ivec4
+vertex_buffer_place_chunked_item( vertex_buffer_t * self,
+                                  size_t vcount, size_t icount,
+                                  size_t vcap, size_t icap,
+                                  ivec2 * capacity )
+{
+    chunk_vector_t * V = self->vertex_chunks;
+    chunk_vector_t * I = self->index_chunks;
+    size_t vsize = V->size, isize = I->size, vstart, istart;
+
+    // Same places as reserved, slack stopping at the end of chunks
+    chunk_vector_reserve_contiguous( V, vcount, &vstart );
+    chunk_vector_reserve_contiguous( I, icount, &istart );
+    vcap = min( vcap, V->chunk_size - vstart % V->chunk_size );
+    icap = icount
+         + (min( icap, I->chunk_size - istart % I->chunk_size ) - icount)
+         / 3 * 3;
+    chunk_vector_resize( V, vstart + vcap );
+    chunk_vector_resize( I, istart + icap );
+
+    // The end of the previous chunks, if skipped, is left as padding
+    if( vstart > vsize )
+    {
+        memset( vertex_buffer_vertex_data( self, vsize ), 0,
+                (vstart - vsize) * V->item_size );
+    }
+    if( vcap > vcount )
+    {
+        memset( vertex_buffer_vertex_data( self, vstart + vcount ), 0,
+                (vcap - vcount) * V->item_size );
+    }
+    vertex_buffer_degenerate( self, isize, istart );
+    vertex_buffer_degenerate( self, istart + icount, istart + icap );
+    vertex_buffer_touch( self, vsize, V->size, isize, I->size );
+    *capacity = (ivec2) {{ vcap, icap }};
+    return (ivec4) {{ vstart, vcount, istart, icount }};
 }
 
-
-
 // ----------------------------------------------------------------------------
-void
-vertex_buffer_push_back_vertices ( vertex_buffer_t * self,
-                                   void * vertices,
-                                   size_t vcount )
+ivec4
+vertex_buffer_place_item( vertex_buffer_t * self,
+                          size_t vcount, size_t icount,
+                          ivec2 * capacity )
 {
-    assert( self );
+    vector_t * V = self->vertices;
+    vector_t * I = self->indices;
+    void * vertices;
+    GLuint * indices;
+
+    // Slack indices are kept a multiple of 3 for triangles to stay aligned
+    size_t vcap = vcount + (size_t) (self->slack * vcount);
+    size_t icap = icount + (size_t) (self->slack * icount) / 3 * 3;
+    if( self->primitive == GL_QUADS )
+    {
+        vcap = vcap / 4 * 4;
+    }
+    ivec4 item = {{ V->size, vcount, I->size, icount }};
 
-    self->dirty = 1;
-    vector_push_back_data( self->vertices, vertices, vcount );
+    if( self->vertex_chunks )
+    {
+        return vertex_buffer_place_chunked_item( self, vcount, icount,
+                                                 vcap, icap, capacity );
+    }
+    if( (vcap > vcount) || (icap > icount) )
+    {
+        vertex_buffer_reserve_item( self, vcap, icap, &vertices, &indices );
+        memset( (char *) vertices + vcount * V->item_size, 0,
+                (vcap - vcount) * V->item_size );
+        vertex_buffer_degenerate( self, I->size + icount, I->size + icap );
+    }
+    V->size += vcap;
+    I->size += icap;
+    vertex_buffer_touch( self, item.vstart, V->size, item.istart, I->size );
+    *capacity = (ivec2) {{ vcap, icap }};
+    return item;
 }
 
-
-
 // ----------------------------------------------------------------------------
-void
-vertex_buffer_insert_indices ( vertex_buffer_t *self,
-                               size_t index,
-                               GLuint *indices,
-                               size_t count )
+size_t
+vertex_buffer_commit_item( vertex_buffer_t * self,
+                           size_t vcount, size_t icount )
 {
     assert( self );
-    assert( self->indices );
-    assert( index < self->indices->size+1 );
-
-    self->dirty = 1;
-    vector_insert_data( self->indices, index, indices, count );
+    assert( !self->uploading );
+    assert( self->vertex_chunks ||
+            (self->vertices->size + vcount) <= self->vertices->capacity );
+    assert( self->index_chunks ||
+            (self->indices->size + icount) <= self->indices->capacity );
+    assert( (self->primitive != GL_QUADS) ||
+            ((icount == 0) && ((vcount % 4) == 0)) );
+
+    ivec2 capacity;
+    ivec4 item = vertex_buffer_place_item( self, vcount, icount, &capacity );
+    size_t index;
+
+    // Reuse a free slot if any
+    if( self->free_item >= 0 )
+    {
+        index = self->free_item;
+        ivec4 * slot = ivec4_vector_at( self->items, index );
+        self->free_item = slot->vstart;
+        *slot = item;
+        *ivec2_vector_at( self->capacities, index ) = capacity;
+        if( self->index )
+        {
+            spatial_index_update( self->index,
+                                  vertex_buffer_item_key( self, index ),
+                                  vertex_buffer_item_bounds( self, index ) );
+        }
+        ivec2 entry = {{ index, item.vstart }};
+        ivec2_vector_push_back( self->order, entry );
+        self->live_vertices += capacity.x;
+        self->live_indices += capacity.y;
+        return index;
+    }
+    index = self->items->size;
+    ivec4_vector_push_back( self->items, item );
+    ivec2_vector_push_back( self->capacities, capacity );
+    vertex_buffer_track_items( self, index );
+    return index;
 }
 
-
-
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_insert_vertices ( vertex_buffer_t *self,
-                                size_t index,
-                                void *vertices,
-                                size_t count )
+vertex_buffer_track_items( vertex_buffer_t * self, size_t first )
 {
     assert( self );
-    assert( self->vertices );
-    assert( index < self->vertices->size+1 );
-
-    self->dirty = 1;
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    assert( first <= self->items->size );
 
+    const ivec4 * items = (const ivec4 *) self->items->items;
     size_t i;
-    for( i=0; i<self->indices->size; ++i )
+
+    for( i=first; i<self->items->size; ++i )
     {
-        if( *(GLuint *)(vector_get( self->indices, i )) > index )
+        // Items written directly have no slack
+        if( self->capacities->size <= i )
+        {
+            ivec2 capacity = {{ items[i].vcount, items[i].icount }};
+            ivec2_vector_push_back( self->capacities, capacity );
+        }
+        const ivec2 * capacity = ivec2_vector_at( self->capacities, i );
+        ivec2 entry = {{ i, items[i].vstart }};
+        ivec2_vector_push_back( self->order, entry );
+        self->live_vertices += capacity->x;
+        self->live_indices += capacity->y;
+        if( self->index )
         {
-            *(GLuint *)(vector_get( self->indices, i )) += index;
+            vertex_buffer_add_key( self, i );
         }
     }
-
-    vector_insert_data( self->vertices, index, vertices, count );
 }
 
-
-
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_erase_indices ( vertex_buffer_t *self,
-                              size_t first,
-                              size_t last )
+vertex_buffer_erase( vertex_buffer_t * self,
+                     size_t index )
 {
     assert( self );
-    assert( self->indices );
-    assert( first < self->indices->size );
-    assert( (last) <= self->indices->size );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    assert( index < vector_size( self->items ) );
 
-    self->dirty = 1;
-    vector_erase_range( self->indices, first, last );
+    ivec4 * item = ivec4_vector_at( self->items, index );
+    ivec2 * capacity = ivec2_vector_at( self->capacities, index );
+    assert( item->icount >= 0 );
+
+    // Indices of the hole are made degenerate, the slot is freed
+    vertex_buffer_degenerate( self, item->istart,
+                              item->istart + item->icount );
+    vertex_buffer_degenerate_quads( self, item->vstart,
+                                    item->vstart + item->vcount );
+    vertex_buffer_touch( self, 0, 0, item->istart,
+                         item->istart + item->icount );
+    self->live_vertices -= capacity->x;
+    self->live_indices -= capacity->y;
+    *item = (ivec4) {{ self->free_item, 0, 0, -1 }};
+    *capacity = (ivec2) {{ 0, 0 }};
+    self->free_item = index;
+    if( self->index )
+    {
+        spatial_index_update( self->index,
+                              vertex_buffer_item_key( self, index ),
+                              (vec4) {{ 0, 0, -1, -1 }} );
+    }
 }
 
-
-
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_erase_vertices ( vertex_buffer_t *self,
-                               size_t first,
-                               size_t last )
+vertex_buffer_set_scratch( vertex_buffer_t * self,
+                           const allocator_t * scratch )
 {
     assert( self );
-    assert( self->vertices );
-    assert( first < self->vertices->size );
-    assert( (first+last) <= self->vertices->size );
-    assert( last > first );
+    assert( !self->uploading );
 
-    self->dirty = 1;
-    size_t i;
-    for( i=0; i<self->indices->size; ++i )
-    {
-        if( *(GLuint *)(vector_get( self->indices, i )) > first )
-        {
-            *(GLuint *)(vector_get( self->indices, i )) -= (last-first);
-        }
-    }
-    vector_erase_range( self->vertices, first, last );    
+    self->scratch = scratch;
 }
 
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_set_slack( vertex_buffer_t * self, float slack )
+{
+    assert( self );
+    assert( !self->uploading );
+    assert( slack >= 0 );
 
+    self->slack = slack;
+}
 
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_append( vertex_buffer_t * self,
-                      void * vertices, size_t vcount,  
-                      GLuint * indices, size_t icount )
+vertex_buffer_set_capacity_policy( vertex_buffer_t * self,
+                                   float decay, size_t shrink_frames )
 {
-    vertex_buffer_insert( self, vector_size( self->items ),
-                          vertices, vcount, indices, icount );
+    assert( self );
+    assert( (decay >= 0) && (decay <= 1) );
+
+    self->capacity_decay = decay;
+    self->shrink_frames = shrink_frames;
+    memset( self->quiet_frames, 0, sizeof(self->quiet_frames) );
 }
 
 // ----------------------------------------------------------------------------
 void
-vertex_buffer_insert( vertex_buffer_t * self,
-                      size_t index,
-                      void * vertices, size_t vcount,  
-                      GLuint * indices, size_t icount )
+vertex_buffer_update_item( vertex_buffer_t * self,
+                           size_t index,
+                           void * vertices, size_t vcount,
+                           GLuint * indices, size_t icount )
 {
     assert( self );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    assert( index < vector_size( self->items ) );
     assert( vertices );
-    assert( indices );
+    assert( indices || !icount );
+    assert( (self->primitive != GL_QUADS) ||
+            ((icount == 0) && ((vcount % 4) == 0)) );
 
-    // Push back vertices
-    size_t vstart = vector_size( self->vertices );
-    vertex_buffer_push_back_vertices( self, vertices, vcount );
+    ivec4 * item = ivec4_vector_at( self->items, index );
+    ivec2 * capacity = ivec2_vector_at( self->capacities, index );
+    assert( item->icount >= 0 );
 
-    // Push back indices
-    size_t istart = vector_size( self->indices );
-    vertex_buffer_push_back_indices( self, indices, icount );
+    size_t vstart = item->vstart, istart = item->istart, i;
+    size_t vcount_ = item->vcount, icount_ = item->icount;
+    int moved = 0;
+    void * V;
+    GLuint * I;
 
-    // Update indices within the vertex buffer
-    size_t i;
+    if( (vcount <= (size_t) capacity->x) && (icount <= (size_t) capacity->y) )
+    {
+        // In place, indices left over from the former geometry are made
+        // degenerate
+        V = vertex_buffer_vertex_data( self, vstart );
+        I = vertex_buffer_index_data( self, istart );
+        vertex_buffer_degenerate( self, istart + icount, istart + icount_ );
+        vertex_buffer_degenerate_quads( self, vstart + vcount,
+                                        vstart + vcount_ );
+        vertex_buffer_touch( self, vstart, vstart + vcount,
+                             istart, istart + max( icount, icount_ ) );
+        item->vcount = vcount;
+        item->icount = icount;
+    }
+    else
+    {
+        // Moved at the end, former storage is left as a hole
+        vertex_buffer_degenerate( self, istart, istart + icount_ );
+        vertex_buffer_degenerate_quads( self, vstart, vstart + vcount_ );
+        vertex_buffer_touch( self, 0, 0, istart, istart + icount_ );
+        self->live_vertices -= capacity->x;
+        self->live_indices -= capacity->y;
+        vstart = vertex_buffer_reserve_item( self, vcount, icount, &V, &I );
+        moved = 1;
+    }
+    memcpy( V, vertices, vcount * self->vertices->item_size );
     for( i=0; i<icount; ++i )
     {
-        *(GLuint *)(vector_get( self->indices, istart+i )) += vstart;
+        I[i] = (indices[i] == VERTEX_BUFFER_RESTART_INDEX)
+             ? VERTEX_BUFFER_RESTART_INDEX : indices[i] + vstart;
+    }
+    if( moved )
+    {
+        *item = vertex_buffer_place_item( self, vcount, icount, capacity );
+        ivec2 entry = {{ index, item->vstart }};
+        ivec2_vector_push_back( self->order, entry );
+        self->live_vertices += capacity->x;
+        self->live_indices += capacity->y;
+    }
+    if( self->index )
+    {
+        spatial_index_update( self->index,
+                              vertex_buffer_item_key( self, index ),
+                              vertex_buffer_item_bounds( self, index ) );
     }
-    
-    // Insert item
-    ivec4 item = {{ vstart, vcount, istart, icount }};
-    vector_insert( self->items, index, &item );
 }
 
 // ----------------------------------------------------------------------------
-void
-vertex_buffer_erase( vertex_buffer_t * self,
-                     size_t index )
+size_t
+vertex_buffer_compact( vertex_buffer_t * self, size_t budget )
 {
     assert( self );
-    assert( index < vector_size( self->items ) );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
 
-    ivec4 * item = vector_get( self->items, index );
-    size_t vstart = item->vstart;
-    size_t vcount = item->vcount;
-    size_t istart = item->istart;
-    size_t icount = item->icount;
+    vector_t * V = self->vertices;
+    ivec2 * order = (ivec2 *) self->order->items;
+    ivec4 * items = (ivec4 *) self->items->items;
+    ivec2 * capacities = (ivec2 *) self->capacities->items;
+    size_t moved = 0, i;
 
-    // Update items
-    size_t i;
-    for( i=0; i<vector_size(self->items); ++i )
+    // Chunked storage is not compacted
+    if( self->vertex_chunks )
+    {
+        return 0;
+    }
+    if( !self->compact_read &&
+        (V->size == self->live_vertices) &&
+        (self->indices->size == self->live_indices) )
     {
-        ivec4 * item = vector_get( self->items, i );
-        if( item->vstart > vstart)
+        return 0;
+    }
+
+    // Live items are moved down in storage order, holes (stale entries of
+    // the order) are skipped
+    while( (self->compact_read < self->order->size) && (moved < budget) )
+    {
+        ivec2 entry = order[self->compact_read++];
+        ivec4 * item = &items[entry.x];
+        if( (item->icount < 0) || (item->vstart != entry.y) )
+        {
+            continue;
+        }
+        size_t vstart = item->vstart, vcap = capacities[entry.x].x;
+        size_t istart = item->istart, icap = capacities[entry.x].y;
+        size_t icount = item->icount;
+        size_t vdst = self->compact_vertex, idst = self->compact_index;
+        if( (vstart != vdst) || (istart != idst) )
         {
-            item->vstart -= vcount;
-            item->istart -= icount;
+            GLuint * indices = (GLuint *) self->indices->items;
+            memmove( (char *) V->items + vdst * V->item_size,
+                     (char *) V->items + vstart * V->item_size,
+                     vcap * V->item_size );
+            memmove( indices + idst, indices + istart,
+                     icap * sizeof(GLuint) );
+            for( i=idst; i<idst+icount; ++i )
+            {
+                if( indices[i] != VERTEX_BUFFER_RESTART_INDEX )
+                {
+                    indices[i] -= (vstart - vdst);
+                }
+            }
+            vertex_buffer_degenerate( self, max( idst+icap, istart ),
+                                      istart+icap );
+            vertex_buffer_degenerate_quads( self, max( vdst+vcap, vstart ),
+                                            vstart+vcap );
+            vertex_buffer_touch( self, vdst, vstart+vcap, idst, istart+icap );
+            item->vstart = vdst;
+            item->istart = idst;
+            moved += vcap + icap;
         }
+        order[self->compact_write++] = (ivec2) {{ entry.x, vdst }};
+        self->compact_vertex += vcap;
+        self->compact_index += icap;
+    }
+
+    // Pass complete: storage is truncated
+    if( self->compact_read == self->order->size )
+    {
+        V->size = self->compact_vertex;
+        self->indices->size = self->compact_index;
+        self->order->size = self->compact_write;
+        self->compact_read = self->compact_write = 0;
+        self->compact_vertex = self->compact_index = 0;
     }
-    vertex_buffer_erase_indices( self, istart, istart+icount );
-    vertex_buffer_erase_vertices( self, istart, vstart+vcount );
-    vector_erase( self->items, index );
+    return moved;
 }
 
 
@@ -875,3 +2670,380 @@ GL_TYPE_STRING( GLenum gtype )
     default:                return "GL_VOID";
     }
 }
+
+
+// ----------------------------------------------------------------------------
+vec4
+vertex_buffer_item_bounds( vertex_buffer_t * self, size_t index )
+{
+    assert( self );
+    assert( index < vertex_buffer_size( self ) );
+
+    // Items after an open gap are found past it
+    if( self->gap_open && (index >= self->gap) )
+    {
+        index += self->gap_size;
+    }
+    return vertex_buffer_slot_bounds( self, index );
+}
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_enable_index( vertex_buffer_t * self, float cell_size )
+{
+    assert( self );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+
+    size_t i;
+    if( self->index )
+    {
+        spatial_index_delete( self->index );
+    }
+    self->index = spatial_index_new( cell_size );
+    vector_clear( self->item_keys );
+    vector_clear( self->key_slots );
+    for( i=0; i<vector_size( self->items ); ++i )
+    {
+        vertex_buffer_add_key( self, i );
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// Position of an item in draw order: its first index, or its first vertex
+// when vertices are drawn without indices
+size_t
+vertex_buffer_item_position( const vertex_buffer_t * self,
+                             const ivec4 * item )
+{
+    return vertex_buffer_index_count( self ) ? item->istart : item->vstart;
+}
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_query( vertex_buffer_t * self, vec4 rect, vector_t * result )
+{
+    assert( self );
+    assert( self->index );
+
+    size_t i, n = spatial_index_query( self->index, rect, result );
+    size_t * handles = (size_t *) result->items;
+    const ivec4 * items = (const ivec4 *) self->items->items;
+
+    // Reused slots and moved items are drawn after items with greater
+    // handles: results are sorted by position in draw order. The index
+    // holds keys, mapped to handles past an open gap.
+    vector_t * entries = vector_new_with_allocator( sizeof(ivec2),
+                                                    self->scratch );
+    vector_resize( entries, n );
+    ivec2 * E = (ivec2 *) entries->items;
+    for( i=0; i<n; ++i )
+    {
+        size_t slot = vertex_buffer_key_slot( self, handles[i] );
+        E[i].x = vertex_buffer_slot_handle( self, slot );
+        E[i].y = vertex_buffer_item_position( self, &items[slot] );
+    }
+    qsort( E, n, sizeof(ivec2), vertex_buffer_order_compare );
+    for( i=0; i<n; ++i )
+    {
+        handles[i] = E[i].x;
+    }
+    vector_delete( entries );
+    return n;
+}
+
+
+// ----------------------------------------------------------------------------
+size_t
+vertex_buffer_nearest( vertex_buffer_t * self, vec2 point,
+                       float max_distance )
+{
+    assert( self );
+    assert( self->index );
+
+    size_t i, best = spatial_index_nearest( self->index, point,
+                                            max_distance );
+    if( best == (size_t) -1 )
+    {
+        return best;
+    }
+
+    // Among the boxes at the nearest distance, the one drawn last wins.
+    // Candidates are found with a slightly larger rectangle, float rounding
+    // of its sides being covered by the margin.
+    const ivec4 * items = (const ivec4 *) self->items->items;
+    const vec4 * bounds = (const vec4 *) self->index->bounds->items;
+    double d = spatial_index_distance( bounds[best], point );
+    double r = sqrt( d ) * (1 + 1e-4)
+             + 1e-5 * (fabs( point.x ) + fabs( point.y )) + 1e-3;
+    vec4 rect = {{ point.x - r, point.y - r, 2*r, 2*r }};
+    vector_t * found = vector_new_with_allocator( sizeof(size_t),
+                                                  self->scratch );
+    size_t n = spatial_index_query( self->index, rect, found );
+    const size_t * keys = (const size_t *) found->items;
+    size_t slot = vertex_buffer_key_slot( self, best );
+    size_t position = vertex_buffer_item_position( self, &items[slot] );
+    for( i=0; i<n; ++i )
+    {
+        size_t s = vertex_buffer_key_slot( self, keys[i] );
+        size_t p = vertex_buffer_item_position( self, &items[s] );
+        if( (p > position) &&
+            (spatial_index_distance( bounds[keys[i]], point ) <= d) )
+        {
+            slot = s;
+            position = p;
+        }
+    }
+    vector_delete( found );
+    return vertex_buffer_slot_handle( self, slot );
+}
+
+
+
+// ----------------------------------------------------------------------------
+uint64_t
+vertex_buffer_hash( const void * data, size_t size, uint64_t hash )
+{
+    const unsigned char * bytes = (const unsigned char *) data;
+    size_t i;
+
+    for( i=0; i<size; ++i )
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+
+// ----------------------------------------------------------------------------
+int
+vertex_buffer_save( vertex_buffer_t * self,
+                    const char * filename,
+                    uint64_t hash )
+{
+    assert( self );
+    assert( filename );
+
+    // Files hold no insertion gap
+    vertex_buffer_close_gap( self );
+
+    static const char padding[VERTEX_BUFFER_FILE_ALIGN];
+    vertex_buffer_file_t header;
+    const vector_t * sections[5] = { self->vertices, self->indices,
+                                     self->items, self->capacities,
+                                     self->order };
+    const chunk_vector_t * chunks[5] = { self->vertex_chunks,
+                                         self->index_chunks, 0, 0, 0 };
+    uint64_t * offsets[5] = { &header.vertices, &header.indices,
+                              &header.items, &header.capacities,
+                              &header.order };
+    size_t counts[5];
+    size_t offset, size, i, j;
+    FILE * file;
+    int ok;
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, VERTEX_BUFFER_FILE_MAGIC, sizeof(header.magic) );
+    header.version = VERTEX_BUFFER_FILE_VERSION;
+    header.primitive = self->primitive;
+    header.hash = hash;
+    header.format_size = strlen( self->format ) + 1;
+    header.vertex_size = self->vertices->item_size;
+    header.vertex_count = vertex_buffer_vertex_count( self );
+    header.index_count = vertex_buffer_index_count( self );
+    header.item_count = self->items->size;
+    header.order_count = self->order->size;
+    header.free_item = self->free_item;
+    header.live_vertices = self->live_vertices;
+    header.live_indices = self->live_indices;
+    header.compact_read = self->compact_read;
+    header.compact_write = self->compact_write;
+    header.compact_vertex = self->compact_vertex;
+    header.compact_index = self->compact_index;
+    offset = sizeof(header) + header.format_size;
+    for( i=0; i<5; ++i )
+    {
+        counts[i] = chunks[i] ? chunks[i]->size : sections[i]->size;
+        offset = (offset + VERTEX_BUFFER_FILE_ALIGN - 1)
+               / VERTEX_BUFFER_FILE_ALIGN * VERTEX_BUFFER_FILE_ALIGN;
+        *offsets[i] = offset;
+        offset += counts[i] * sections[i]->item_size;
+    }
+    header.size = offset;
+
+    file = fopen( filename, "wb" );
+    if( !file )
+    {
+        fprintf( stderr, "Unable to open file \"%s\".\n", filename );
+        return 0;
+    }
+    ok = (fwrite( &header, sizeof(header), 1, file ) == 1)
+      && (fwrite( self->format, header.format_size, 1, file ) == 1);
+    offset = sizeof(header) + header.format_size;
+    for( i=0; ok && (i<5); ++i )
+    {
+        ok = (fwrite( padding, 1, *offsets[i] - offset, file )
+              == *offsets[i] - offset);
+        offset = *offsets[i] + counts[i] * sections[i]->item_size;
+
+        // Chunks are written one after the other
+        for( j=0; ok && chunks[i] && (j<counts[i]); j+=chunks[i]->chunk_size )
+        {
+            size = min( chunks[i]->chunk_size, counts[i] - j )
+                 * chunks[i]->item_size;
+            ok = (fwrite( chunk_vector_chunk( chunks[i],
+                                              j / chunks[i]->chunk_size ),
+                          1, size, file ) == size);
+        }
+        if( ok && !chunks[i] )
+        {
+            size = counts[i] * sections[i]->item_size;
+            ok = (fwrite( sections[i]->items, 1, size, file ) == size);
+        }
+    }
+    ok = (fclose( file ) == 0) && ok;
+    if( !ok )
+    {
+        fprintf( stderr, "Unable to write file \"%s\".\n", filename );
+        remove( filename );
+    }
+    return ok;
+}
+
+
+
+// ----------------------------------------------------------------------------
+vertex_buffer_t *
+vertex_buffer_load_mmap( const char * filename, uint64_t hash )
+{
+    assert( filename );
+
+    const vertex_buffer_file_t * header;
+    vertex_buffer_t * self;
+    struct stat status;
+    char * mapping;
+    size_t i;
+    int file;
+
+    file = open( filename, O_RDONLY );
+    if( file < 0 )
+    {
+        return 0;
+    }
+    if( fstat( file, &status ) ||
+        ((size_t) status.st_size < sizeof(*header)) )
+    {
+        close( file );
+        return 0;
+    }
+
+    // Private mapping: pages are shared with the page cache until written
+    mapping = mmap( 0, status.st_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE, file, 0 );
+    close( file );
+    if( mapping == MAP_FAILED )
+    {
+        return 0;
+    }
+    header = (const vertex_buffer_file_t *) mapping;
+
+    // Sections must lie within the file
+    uint64_t ends[5] = {
+        header->vertices + header->vertex_count * header->vertex_size,
+        header->indices + header->index_count * sizeof(GLuint),
+        header->items + header->item_count * sizeof(ivec4),
+        header->capacities + header->item_count * sizeof(ivec2),
+        header->order + header->order_count * sizeof(ivec2) };
+    int valid = !memcmp( header->magic, VERTEX_BUFFER_FILE_MAGIC,
+                         sizeof(header->magic) )
+             && (header->version == VERTEX_BUFFER_FILE_VERSION)
+             && (header->hash == hash)
+             && (header->size == (uint64_t) status.st_size)
+             && (header->format_size > 1)
+             && (header->format_size < header->size - sizeof(*header))
+             && !mapping[sizeof(*header) + header->format_size - 1];
+    for( i=0; valid && (i<5); ++i )
+    {
+        valid = (ends[i] <= header->size);
+    }
+    if( !valid )
+    {
+        munmap( mapping, status.st_size );
+        return 0;
+    }
+
+    self = vertex_buffer_new( mapping + sizeof(*header) );
+    if( self->vertices->item_size != header->vertex_size )
+    {
+        vertex_buffer_delete( self );
+        munmap( mapping, status.st_size );
+        return 0;
+    }
+
+    // Vertices and indices are used in place
+    allocator_free( self->vertices->allocator, self->vertices->items,
+                    self->vertices->capacity * self->vertices->item_size );
+    self->vertices->items = mapping + header->vertices;
+    self->vertices->size = self->vertices->capacity = header->vertex_count;
+    allocator_free( self->indices->allocator, self->indices->items,
+                    self->indices->capacity * self->indices->item_size );
+    self->indices->items = mapping + header->indices;
+    self->indices->size = self->indices->capacity = header->index_count;
+    self->mapping = mapping;
+    self->mapping_size = status.st_size;
+
+    vector_resize( self->items, header->item_count );
+    memcpy( self->items->items, mapping + header->items,
+            header->item_count * sizeof(ivec4) );
+    vector_resize( self->capacities, header->item_count );
+    memcpy( self->capacities->items, mapping + header->capacities,
+            header->item_count * sizeof(ivec2) );
+    vector_resize( self->order, header->order_count );
+    memcpy( self->order->items, mapping + header->order,
+            header->order_count * sizeof(ivec2) );
+    self->primitive = header->primitive;
+    self->free_item = header->free_item;
+    self->live_vertices = header->live_vertices;
+    self->live_indices = header->live_indices;
+    self->compact_read = header->compact_read;
+    self->compact_write = header->compact_write;
+    self->compact_vertex = header->compact_vertex;
+    self->compact_index = header->compact_index;
+    return self;
+}
+
+
+
+// ----------------------------------------------------------------------------
+void
+vertex_buffer_unmap( vertex_buffer_t * self )
+{
+    assert( self );
+    assert( !self->uploading );
+
+    vector_t * vectors[2] = { self->vertices, self->indices };
+    size_t i;
+
+    if( !self->mapping )
+    {
+        return;
+    }
+    for( i=0; i<2; ++i )
+    {
+        size_t capacity = max( vectors[i]->size, 1 );
+        void * items = allocator_alloc( vectors[i]->allocator,
+                                        capacity * vectors[i]->item_size );
+        memcpy( items, vectors[i]->items,
+                vectors[i]->size * vectors[i]->item_size );
+        vectors[i]->items = items;
+        vectors[i]->capacity = capacity;
+    }
+    munmap( self->mapping, self->mapping_size );
+    self->mapping = 0;
+    self->mapping_size = 0;
+}
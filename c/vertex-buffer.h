@@ -38,10 +38,36 @@
 #else
     #include <GL/gl.h>
 #endif
+#include <stdint.h>
 #include "vector.h"
+#include "typed-vector.h"
+#include "chunk-vector.h"
+#include "spatial-index.h"
 
 #define MAX_VERTEX_ATTRIBUTE 16
 
+/**
+ * Index separating two triangle strips when a vertex buffer stores its items
+ * as GL_TRIANGLE_STRIP (see vertex_buffer_set_primitive).
+ */
+#define VERTEX_BUFFER_RESTART_INDEX 0xFFFFFFFF
+
+/**
+ * Typed operations on index vectors (see typed-vector.h).
+ */
+TYPED_VECTOR( index_vector, GLuint )
+
+/**
+ * Version of the binary format written by vertex_buffer_save, files of
+ * another version being ignored by vertex_buffer_load_mmap.
+ */
+#define VERTEX_BUFFER_FILE_VERSION 1
+
+/**
+ * Initial value of a content hash (see vertex_buffer_hash).
+ */
+#define VERTEX_BUFFER_HASH_SEED 14695981039346656037ULL
+
 
 /**
  * @file   vertex-buffer.h
@@ -113,6 +139,77 @@ typedef struct
 } vertex_attribute_t;
 
 
+/**
+ * Identifiers of the formats used by the library tessellators, registered
+ * first (see vertex_format_get).
+ */
+#define VERTEX_FORMAT_V3F_C4F_T3F 1
+#define VERTEX_FORMAT_V3F_C4F_T4F 2
+
+
+/**
+ * Vertex format descriptor, parsed once per distinct format string and
+ * shared (read only) by all the vertex buffers of that format.
+ */
+typedef struct
+{
+    /** Identifier of the format (1 for the first registered format). */
+    int id;
+
+    /** Format string. */
+    char * format;
+
+    /** Hash of the format string (see vertex_buffer_hash). */
+    uint64_t hash;
+
+    /** Size of a vertex in bytes. */
+    GLsizei stride;
+
+    /** Number of attributes. */
+    size_t n_attributes;
+
+    /** Attributes, their offsets (pointer) and stride being set. */
+    vertex_attribute_t * attributes[MAX_VERTEX_ATTRIBUTE];
+
+    /** Known attributes (see vertex_attribute_bit) of the format. */
+    unsigned int mask;
+
+    /** Attributes (bit i for attribute i) enabled whatever is rendered. */
+    unsigned int generic_mask;
+} vertex_format_t;
+
+
+
+/**
+ * Memory counters of a vertex buffer (see vertex_buffer_get_stats).
+ */
+typedef struct
+{
+    /**
+     * Counters of the vectors of the buffer (items tables, chunks and
+     * spatial index included), summed.
+     */
+    vector_stats_t cpu;
+
+    /** Number of items, vertices and indices. */
+    size_t items, vertices, indices;
+
+    /** Bytes of vertices and indices not used by items (holes, slack). */
+    size_t hole_bytes;
+
+    /** Bytes allocated for the GPU buffers. */
+    size_t gpu_bytes;
+
+    /** Bytes uploaded since the stats were reset. */
+    size_t upload_bytes;
+
+    /** Number of full uploads since the stats were reset. */
+    size_t full_uploads;
+
+    /** Number of GPU storage allocations since the stats were reset. */
+    size_t gpu_allocations;
+} vertex_buffer_stats_t;
+
 
 /**
  * Generic vertex buffer.
@@ -120,7 +217,10 @@ typedef struct
 typedef struct
 {
     /** Format of the vertex buffer. */
-    char * format;
+    const char * format;
+
+    /** Format descriptor (shared by the buffers of the same format). */
+    const vertex_format_t * descriptor;
 
     /** Vector of vertices. */
     vector_t * vertices;
@@ -134,17 +234,152 @@ typedef struct
     /** GL identity of the indices buffer. */
     GLuint indices_id;
 
+    /**
+     * Chunked vertices and indices (0 unless created by
+     * vertex_buffer_new_chunked), the vertices and indices vectors being
+     * then left empty.
+     */
+    chunk_vector_t * vertex_chunks, * index_chunks;
+
     /** GL primitives to render. */
     GLenum mode;
 
+    /**
+     * Primitives tessellators store items as: GL_TRIANGLES (default),
+     * GL_TRIANGLE_STRIP, each item then ending with a restart index, or
+     * GL_QUADS, items having no index (see vertex_buffer_set_primitive).
+     */
+    GLenum primitive;
+
     /** Whether the vertex buffer needs to be uploaded to GPU memory. */
     char dirty;
 
-    /** Individual items */
+    /**
+     * Whether the buffer is being uploaded by an upload queue (see
+     * upload-queue.h), it must then be neither modified nor rendered:
+     * modifying functions assert on it and rendering skips the buffer.
+     */
+    char uploading;
+
+    /**
+     * Ranges of vertices and indices (first, last) to be uploaded when the
+     * whole buffer is not dirty.
+     */
+    vector_t * dirty_vertices, * dirty_indices;
+
+    /** Capacity of the GPU buffers (number of vertices and indices). */
+    size_t gpu_vertices, gpu_indices;
+
+    /**
+     * High-water marks of the number of vertices, indices and items, decayed
+     * at each vertex_buffer_clear (see vertex_buffer_set_capacity_policy).
+     */
+    double high_vertices, high_indices, high_items;
+
+    /** Decay of the high-water marks at each clear. */
+    float capacity_decay;
+
+    /** Number of quiet frames before capacities are shrunk (0 never). */
+    size_t shrink_frames;
+
+    /**
+     * Number of consecutive quiet frames of the vertices, indices, items,
+     * capacities and order vectors, each being shrunk on its own.
+     */
+    size_t quiet_frames[5];
+
+    /**
+     * Individual items, indexed by stable handles: erasing an item frees
+     * its slot (icount set to -1 and vstart linking to the next free slot)
+     * and leaves a hole in the vertices and indices until compaction.
+     */
     vector_t * items;
 
-    /** Array of attributes. */
+    /** Reserved capacity of each item (vertices, indices), slack included. */
+    vector_t * capacities;
+
+    /** Extra capacity given to new items, as a fraction of their size. */
+    float slack;
+
+    /** First free item slot (-1 if none). */
+    int free_item;
+
+    /** Items in storage order (item, vstart), stale entries being holes. */
+    vector_t * order;
+
+    /** Number of vertices and indices reserved by items (holes excepted). */
+    size_t live_vertices, live_indices;
+
+    /** Incremental compaction progress: read and write positions in order. */
+    size_t compact_read, compact_write;
+
+    /** Incremental compaction progress: first vertex and index to fill. */
+    size_t compact_vertex, compact_index;
+
+    /**
+     * Gap of free slots [gap, gap+gap_size) left in the items and capacities
+     * tables while items are inserted by vertex_buffer_insert, so that
+     * nearby insertions do not move the following items. The gap is closed
+     * (see vertex_buffer_close_gap) by any other operation modifying or
+     * rendering items.
+     */
+    size_t gap, gap_size;
+
+    /** Whether a gap is open. */
+    char gap_open;
+
+    /** Items inserted since the gap was opened (one mark per slot). */
+    vector_t * gap_marks;
+
+    /** Number of items and order entries when the gap was opened. */
+    size_t gap_items, gap_order;
+
+    /**
+     * File mapping the vertices and indices are stored into when loaded by
+     * vertex_buffer_load_mmap (0 otherwise).
+     */
+    void * mapping;
+
+    /** Size of the file mapping. */
+    size_t mapping_size;
+
+    /**
+     * Allocator of the scratch memory of tessellators (0 for the system
+     * one), typically a frame arena.
+     */
+    const allocator_t * scratch;
+
+    /** Spatial index of the items bounding boxes (0 unless enabled). */
+    spatial_index_t * index;
+
+    /**
+     * Keys of the items in the spatial index (one per slot of the items
+     * table, moved with the gap) and slot of the item of each key. Keys
+     * never change, so that moving items renumbers nothing in the index.
+     */
+    vector_t * item_keys, * key_slots;
+
+    /**
+     * Bytes uploaded, number of full uploads and of GPU storage allocations
+     * since the stats reset.
+     */
+    size_t upload_bytes, full_uploads, gpu_allocations;
+
+    /** Array of attributes (those of the format descriptor). */
     vertex_attribute_t *attributes[MAX_VERTEX_ATTRIBUTE];
+
+    /**
+     * Attributes enabled when rendering with enabled_mask (see
+     * vertex_buffer_render_setup_mask), computed again only when the mask
+     * changes.
+     */
+    vertex_attribute_t *enabled[MAX_VERTEX_ATTRIBUTE];
+
+    /** Number of enabled attributes. */
+    size_t n_enabled;
+
+    /** Mask of the enabled attributes (~0 before the first render). */
+    unsigned int enabled_mask;
 } vertex_buffer_t;
 
 
@@ -158,6 +393,36 @@ typedef struct
   vertex_buffer_new( const char *format );
 
 
+/**
+ * Creates an empty vertex buffer whose memory comes from an allocator.
+ *
+ * @param  format     a string describing vertex format.
+ * @param  allocator  an allocator (0 for the system one)
+ * @return            an empty vertex buffer.
+ */
+  vertex_buffer_t *
+  vertex_buffer_new_with_allocator( const char *format,
+                                    const allocator_t *allocator );
+
+
+/**
+ * Creates an empty vertex buffer whose vertices and indices are stored into
+ * chunks, such that growing never copies nor moves them. Items never span
+ * two chunks (the end of a chunk is skipped if needed) and chunked buffers
+ * are not compacted. Items must be added through vertex_buffer_append or
+ * vertex_buffer_reserve_item (not by polyline batches nor the functions
+ * pushing or inserting raw vertices and indices).
+ *
+ * @param  format      a string describing vertex format.
+ * @param  chunk_size  number of vertices (and indices) per chunk, greater
+ *                     than the size of any item
+ * @return             an empty vertex buffer.
+ */
+  vertex_buffer_t *
+  vertex_buffer_new_chunked( const char *format,
+                             size_t chunk_size );
+
+
 /**
  * Creates a vertex buffer from data.
  *
@@ -203,6 +468,94 @@ typedef struct
   const char *
   vertex_buffer_format( const vertex_buffer_t *self );
 
+
+/**
+ * Returns the format identifier of a vertex buffer, such that checking the
+ * format is an integer compare.
+ *
+ *  @param  self  a vertex buffer
+ *  @return       format identifier (see vertex_format_get)
+ */
+  int
+  vertex_buffer_format_id( const vertex_buffer_t *self );
+
+
+/**
+ * Returns the descriptor of a format, parsing the format the first time
+ * it is seen. Descriptors are never freed and can be shared between
+ * threads.
+ *
+ *  @param  format  a format string such as "v3f:c4f:t3f"
+ *  @return         the format descriptor
+ */
+  const vertex_format_t *
+  vertex_format_get( const char * format );
+
+
+/**
+ * Returns the descriptor of a registered format.
+ *
+ *  @param  id  a format identifier
+ *  @return     the format descriptor, 0 if there is none
+ */
+  const vertex_format_t *
+  vertex_format_from_id( int id );
+
+
+/**
+ * Returns the bit of a known attribute in the masks of format descriptors.
+ *
+ *  @param  ctarget  attribute letter, one of "vcntfse"
+ *  @return          bit of the attribute, 0 for other letters
+ */
+  unsigned int
+  vertex_attribute_bit( char ctarget );
+
+
+/**
+ * Compiles the attributes to be rendered, such as "vtc", into a mask to be
+ * given to vertex_buffer_render_mask and the like. Generic attributes are
+ * always rendered and have no bit.
+ *
+ *  @param  what  attribute letters among "vcntfse"
+ *  @return       mask of the attributes
+ */
+  unsigned int
+  vertex_attribute_mask( const char * what );
+
+/**
+ *  Sets the primitives tessellators store items as. With GL_TRIANGLE_STRIP,
+ *  every item is a sequence of strips separated (and terminated) by
+ *  VERTEX_BUFFER_RESTART_INDEX and the buffer must be rendered with
+ *  GL_TRIANGLE_STRIP, primitive restart being enabled while rendering.
+ *
+ *  With GL_QUADS, items are lists of quads (4 vertices each, such as
+ *  circles and vertex_buffer_add_line_2) stored without indices, and the
+ *  buffer is rendered with GL_TRIANGLES through an index buffer shared by
+ *  all such buffers (see vertex_buffer_quad_indices). Erased vertices are
+ *  zeroed, making their triangles degenerate.
+ *
+ *  @param  self       an empty vertex buffer (chunked buffers need chunks
+ *                     of a multiple of 4 vertices for GL_QUADS)
+ *  @param  primitive  GL_TRIANGLES, GL_TRIANGLE_STRIP or GL_QUADS
+ */
+  void
+  vertex_buffer_set_primitive( vertex_buffer_t *self,
+                               GLenum primitive );
+
+
+/**
+ *  Returns the index buffer shared by the buffers storing quads, holding
+ *  the triangles { 4i, 4i+1, 4i+2, 4i, 4i+2, 4i+3 } of at least the given
+ *  number of quads. It is grown (geometrically) when needed and must be
+ *  used from the rendering thread (or contexts sharing objects with it).
+ *
+ *  @param  quads  number of quads
+ *  @return        GL name of the index buffer
+ */
+  GLuint
+  vertex_buffer_quad_indices( size_t quads );
+
 /**
  * Print information about a vertex buffer
  *
@@ -212,6 +565,40 @@ typedef struct
   vertex_buffer_print( vertex_buffer_t * self );
 
 
+/**
+ * Get the memory counters of a vertex buffer.
+ *
+ * @param  self   a vertex buffer
+ * @param  stats  counters to fill
+ */
+  void
+  vertex_buffer_get_stats( const vertex_buffer_t * self,
+                           vertex_buffer_stats_t * stats );
+
+
+/**
+ * Reset the upload counters of a vertex buffer, typically once per frame
+ * such that they measure uploads per frame.
+ *
+ * @param  self  a vertex buffer
+ */
+  void
+  vertex_buffer_reset_stats( vertex_buffer_t * self );
+
+
+/**
+ * Print the memory counters of a vertex buffer as a single line of text or
+ * as a JSON object.
+ *
+ * @param  self    a vertex buffer
+ * @param  stream  output stream
+ * @param  json    whether to print a JSON object
+ */
+  void
+  vertex_buffer_print_stats( const vertex_buffer_t * self,
+                             FILE * stream, int json );
+
+
 /**
  * Immediate draw
  *
@@ -253,6 +640,18 @@ typedef struct
   vertex_buffer_render_setup ( vertex_buffer_t *self,
                                GLenum mode, const char *what );
 
+/**
+ * Prepare vertex buffer for render, attributes being given as a mask
+ * compiled once with vertex_attribute_mask.
+ *
+ * @param  self  a vertex buffer
+ * @param  mode  render mode
+ * @param  mask  attributes to be rendered (see vertex_attribute_mask)
+ */
+  void
+  vertex_buffer_render_setup_mask ( vertex_buffer_t *self,
+                                    GLenum mode, unsigned int mask );
+
 /**
  * Finish rendering by setting back modified states
  *
@@ -274,6 +673,18 @@ typedef struct
                          GLenum mode, const char *what );
 
 
+/**
+ * Render vertex buffer, attributes being given as a mask.
+ *
+ * @param  self  a vertex buffer
+ * @param  mode  render mode
+ * @param  mask  attributes to be rendered (see vertex_attribute_mask)
+ */
+  void
+  vertex_buffer_render_mask ( vertex_buffer_t *self,
+                              GLenum mode, unsigned int mask );
+
+
 /**
  * Render a specified item from the vertex buffer.
  *
@@ -284,15 +695,80 @@ typedef struct
   vertex_buffer_render_item ( vertex_buffer_t *self,
                               size_t index );
 
+/**
+ * Render the specified items from the vertex buffer, items whose indices
+ * are contiguous being drawn as a single range of a glMultiDrawElements
+ * call.
+ *
+ * @param  self   a vertex buffer
+ * @param  mode   render mode
+ * @param  what   attributes to be rendered
+ * @param  items  indices of the items, in increasing order
+ * @param  count  number of items
+ */
+  void
+  vertex_buffer_render_items ( vertex_buffer_t *self,
+                               GLenum mode, const char *what,
+                               const size_t * items, size_t count );
+
+/**
+ * Render the specified items from the vertex buffer (see
+ * vertex_buffer_render_items), attributes being given as a mask.
+ *
+ * @param  self   a vertex buffer
+ * @param  mode   render mode
+ * @param  mask   attributes to be rendered (see vertex_attribute_mask)
+ * @param  items  indices of the items, in increasing order
+ * @param  count  number of items
+ */
+  void
+  vertex_buffer_render_items_mask ( vertex_buffer_t *self,
+                                    GLenum mode, unsigned int mask,
+                                    const size_t * items, size_t count );
+
 /**
  * Upload buffer to GPU memory.
  *
+ * GPU buffers are allocated with the capacity of the vertices and indices
+ * vectors such that items later appended within that capacity, like
+ * updated items, only need their own range to be uploaded (this is done
+ * when rendering).
+ *
  * @param  self  a vertex buffer
  */
   void
   vertex_buffer_upload( vertex_buffer_t *self );
 
 
+/**
+ * Upload buffer into new GPU buffers, sized as vertex_buffer_upload would.
+ * The buffer is only read, such that this can be done from another thread
+ * whose context shares objects with the rendering one, the buffer being
+ * left unmodified until vertex_buffer_swap_gpu_buffers.
+ *
+ * @param  self         a vertex buffer
+ * @param  vertices_id  a new GL buffer for the vertices
+ * @param  indices_id   a new GL buffer for the indices
+ * @return              number of bytes uploaded
+ */
+  size_t
+  vertex_buffer_upload_copy( const vertex_buffer_t *self,
+                             GLuint vertices_id, GLuint indices_id );
+
+
+/**
+ * Render from GPU buffers filled by vertex_buffer_upload_copy, once their
+ * upload has completed. Former GPU buffers are deleted.
+ *
+ * @param  self         a vertex buffer
+ * @param  vertices_id  GL buffer of the vertices
+ * @param  indices_id   GL buffer of the indices
+ */
+  void
+  vertex_buffer_swap_gpu_buffers( vertex_buffer_t *self,
+                                  GLuint vertices_id, GLuint indices_id );
+
+
 /**
  * Clear all vertices and indices
  *
@@ -402,23 +878,165 @@ typedef struct
                                  size_t last );
 
 
+/**
+ * Reserve room for a new item at the end of the buffer.
+ *
+ * Storage is grown (if needed) such that vcount vertices and icount indices
+ * can be written directly after the current ones, but sizes are left
+ * unchanged until vertex_buffer_commit_item is called. Indices written into
+ * the reserved space must be absolute, i.e. already offset by the returned
+ * vertex start.
+ *
+ * @param  self      a vertex buffer
+ * @param  vcount    maximum number of vertices to be written
+ * @param  icount    maximum number of indices to be written
+ * @param  vertices  pointer on the reserved vertices (out)
+ * @param  indices   pointer on the reserved indices (out)
+ * @return           index of the first reserved vertex
+ */
+  size_t
+  vertex_buffer_reserve_item( vertex_buffer_t * self,
+                              size_t vcount, size_t icount,
+                              void ** vertices, GLuint ** indices );
+
+
+/**
+ * Commit an item previously written into reserved space.
+ *
+ * @param  self    a vertex buffer
+ * @param  vcount  number of vertices actually written
+ * @param  icount  number of indices actually written
+ * @return         handle of the new item (a free slot is reused if any)
+ */
+  size_t
+  vertex_buffer_commit_item( vertex_buffer_t * self,
+                             size_t vcount, size_t icount );
+
+
+/**
+ * Set the allocator tessellators get their temporary memory from, which
+ * can be a frame arena reset once the frame has been tessellated.
+ *
+ * @param  self     a vertex buffer
+ * @param  scratch  an allocator (0 for the system one)
+ */
+  void
+  vertex_buffer_set_scratch( vertex_buffer_t * self,
+                             const allocator_t * scratch );
+
+
+/**
+ * Set the extra capacity reserved for items committed from now on, such
+ * that they can later grow in place (see vertex_buffer_update_item).
+ *
+ * @param  self   a vertex buffer
+ * @param  slack  extra capacity as a fraction of the item size (0 default)
+ */
+  void
+  vertex_buffer_set_slack( vertex_buffer_t * self, float slack );
+
+
+/**
+ * Set how the capacity of a buffer cleared and refilled every frame
+ * follows its usage. Capacities (CPU vectors and GPU storage) are kept
+ * from one frame to the next, full uploads reusing the GPU storage. The
+ * high-water marks of the number of vertices, indices and items are
+ * decayed at each vertex_buffer_clear, and a capacity is shrunk to its
+ * high-water mark once the mark has stayed below half the capacity for
+ * shrink_frames frames in a row.
+ *
+ * @param  self           a vertex buffer
+ * @param  decay          decay of the high-water marks per frame (0.95
+ *                        default)
+ * @param  shrink_frames  number of quiet frames before shrinking (60
+ *                        default, 0 to never shrink)
+ */
+  void
+  vertex_buffer_set_capacity_policy( vertex_buffer_t * self,
+                                     float decay, size_t shrink_frames );
+
+
+/**
+ * Replace the geometry of an item, its handle being left unchanged.
+ *
+ * The geometry is overwritten in place if it fits into the capacity of the
+ * item, only the written range being uploaded afterwards. Otherwise the
+ * item is moved at the end of the buffer (with slack) and its former
+ * storage left as a hole.
+ *
+ * @param  self      a vertex buffer
+ * @param  index     handle of the item
+ * @param  vertices  raw vertices data
+ * @param  vcount    number of vertices
+ * @param  indices   raw indices data (relative to the item vertices)
+ * @param  icount    number of indices
+ */
+  void
+  vertex_buffer_update_item( vertex_buffer_t * self,
+                             size_t index,
+                             void * vertices, size_t vcount,
+                             GLuint * indices, size_t icount );
+
+
+/**
+ * Register items written directly at the end of the items vector (see
+ * polyline-batch.h) such that they can be erased, compacted and indexed.
+ *
+ * @param  self   a vertex buffer
+ * @param  first  index of the first new item
+ */
+  void
+  vertex_buffer_track_items( vertex_buffer_t * self, size_t first );
+
+
 /**
  * Append a new item to the collection.
  *
- * @param  index    location before which to insert item
  * @param  vcount   number of vertices
  * @param  vertices raw vertices data
  * @param  icount   number of indices
  * @param  indices  raw indices data
+ * @return          handle of the new item (a free slot is reused if any)
  */
-  void
+  size_t
   vertex_buffer_append( vertex_buffer_t * self,
                         void * vertices, size_t vcount,  
                         GLuint * indices, size_t icount );
 
 
 /**
- * Insert a new item into the collection.
+ * Erase an item from the collection in O(icount).
+ *
+ * The handles of the other items are left unchanged. The geometry of the
+ * item is left as a hole whose indices are made degenerate until
+ * vertex_buffer_compact reclaims it.
+ *
+ * @param  self   a collection
+ * @param  index  handle of the item
+ */
+  void
+  vertex_buffer_erase( vertex_buffer_t * self,
+                       size_t index );
+
+
+/**
+ * Compact the collection incrementally by moving items down into the holes
+ * left by erased items, typically once per frame. Handles are left
+ * unchanged. Storage is truncated once a full pass has been made.
+ *
+ * @param  self    a collection
+ * @param  budget  number of vertices and indices that may be moved (at
+ *                 least one item is moved if any needs to)
+ * @return         number of vertices and indices moved
+ */
+  size_t
+  vertex_buffer_compact( vertex_buffer_t * self, size_t budget );
+
+
+/**
+ * Insert a new item into the collection. Handles of the following items
+ * are shifted, use vertex_buffer_append for stable handles. Items are
+ * inserted into a gap of the items table (see vertex_buffer_close_gap).
  *
  * @param  self      a collection
  * @param  index     location before which to insert item
@@ -432,6 +1050,131 @@ typedef struct
                         size_t index,
                         void * vertices, size_t vcount,  
                         GLuint * indices, size_t icount );
+
+
+/**
+ * Close the gap left in the items table by vertex_buffer_insert: the
+ * following items are moved once and the handles kept by the buffer
+ * (storage order, free slots) are renumbered, the spatial index keeping
+ * its keys. This is done automatically by the operations modifying or
+ * rendering items (queries, hit-testing and bounds leave the gap open),
+ * consecutive insertions at nearby positions then costing O(1) amortized
+ * instead of moving every following item.
+ *
+ * @param  self  a vertex buffer
+ */
+  void
+  vertex_buffer_close_gap( vertex_buffer_t * self );
+
+/**
+ * Compute the bounding box of an item from the (float) positions of its
+ * vertices.
+ *
+ * @param  self   a vertex buffer
+ * @param  index  index of the item
+ * @return        bounding box (x, y, width, height), width < 0 if empty
+ */
+  vec4
+  vertex_buffer_item_bounds( vertex_buffer_t * self, size_t index );
+
+
+/**
+ * Enable the spatial index of the items of a vertex buffer (existing items
+ * are indexed). The index is then kept up to date as items are inserted
+ * and erased.
+ *
+ * @param  self       a vertex buffer
+ * @param  cell_size  size of the grid cells (see spatial-index.h)
+ */
+  void
+  vertex_buffer_enable_index( vertex_buffer_t * self, float cell_size );
+
+
+/**
+ * Find the items whose bounding box intersects a rectangle, typically the
+ * current view to be given to vertex_buffer_render_items.
+ *
+ * @param  self    a vertex buffer whose index is enabled
+ * @param  rect    rectangle (x, y, width, height)
+ * @param  result  vector of size_t receiving the indices of the items, in
+ *                 draw order (a reused slot or a moved item being drawn
+ *                 after items with greater indices)
+ * @return         number of items found
+ */
+  size_t
+  vertex_buffer_query( vertex_buffer_t * self, vec4 rect, vector_t * result );
+
+
+/**
+ * Find the item whose bounding box is the nearest to a point (hit-testing).
+ * Among items at the same distance (e.g. containing the point), the one
+ * drawn last (on top) is returned.
+ *
+ * @param  self          a vertex buffer whose index is enabled
+ * @param  point         a point
+ * @param  max_distance  maximum distance from the point to the item
+ * @return               index of the item, (size_t) -1 if none
+ */
+  size_t
+  vertex_buffer_nearest( vertex_buffer_t * self, vec2 point,
+                         float max_distance );
+
+
+/**
+ * Update a content hash (64 bits FNV-1a) with some data. Inputs a cached
+ * vertex buffer is made of should be hashed, starting from
+ * VERTEX_BUFFER_HASH_SEED, to invalidate the cache when they change.
+ *
+ * @param  data  data to hash
+ * @param  size  size of data (in bytes)
+ * @param  hash  current hash
+ * @return       updated hash
+ */
+  uint64_t
+  vertex_buffer_hash( const void * data, size_t size, uint64_t hash );
+
+
+/**
+ * Save a vertex buffer (format, vertices, indices and items) to a binary
+ * file, in native byte order. A pending insertion gap is closed first.
+ *
+ * @param  self      a vertex buffer
+ * @param  filename  name of the file
+ * @param  hash      content hash of the inputs the buffer was built from
+ * @return           1 on success, 0 otherwise
+ */
+  int
+  vertex_buffer_save( vertex_buffer_t * self,
+                      const char * filename,
+                      uint64_t hash );
+
+
+/**
+ * Load a vertex buffer saved by vertex_buffer_save.
+ *
+ * The file is mapped in memory and its vertices and indices used as is,
+ * without copy, until the buffer needs to grow (see vertex_buffer_unmap).
+ * The spatial index, if needed, has to be enabled again.
+ *
+ * @param  filename  name of the file
+ * @param  hash      expected content hash
+ * @return           a new vertex buffer, or 0 if the file is missing,
+ *                   invalid, of another version or of another hash
+ */
+  vertex_buffer_t *
+  vertex_buffer_load_mmap( const char * filename, uint64_t hash );
+
+
+/**
+ * Copy vertices and indices of a loaded vertex buffer out of the file
+ * mapping, which is released. This is done before the buffer grows and
+ * must be done before vectors are grown by hand.
+ *
+ * @param  self  a vertex buffer
+ */
+  void
+  vertex_buffer_unmap( vertex_buffer_t * self );
+
 /** @} */
 
 
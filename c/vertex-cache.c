@@ -0,0 +1,503 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "vertex-cache.h"
+
+// Maximum valence whose score is tabulated
+#define VERTEX_CACHE_MAX_VALENCE 64
+
+
+/*
+ * Temporary arrays of the optimizer, sized for the largest item of the
+ * range (vcount vertices, tcount triangles) and allocated once.
+ */
+typedef struct
+{
+    const allocator_t * allocator;
+    size_t vcount, tcount, stride;
+
+    /** Triangles of each vertex: offsets, remaining count and list. */
+    int * offsets, * valence, * adjacency;
+
+    /** Position of each vertex in the simulated cache (-1 if none). */
+    int * position;
+
+    /** Score of each vertex and of each triangle. */
+    float * score, * tscore;
+
+    /** Whether each triangle has been emitted. */
+    char * added;
+
+    /** Emitted indices and new vertex numbers. */
+    GLuint * indices;
+    int * remap;
+
+    /** Vertices being renumbered. */
+    char * vertices;
+
+    /** Scores by cache position and by valence. */
+    float position_score[VERTEX_CACHE_SIZE];
+    float valence_score[VERTEX_CACHE_MAX_VALENCE];
+} vertex_cache_t;
+
+
+// ---------------------------------------------------- vertex_cache_vertex ---
+char *
+vertex_cache_vertex( vertex_buffer_t * self, size_t index )
+{
+    if( self->vertex_chunks )
+    {
+        return (char *) chunk_vector_get( self->vertex_chunks, index );
+    }
+    return (char *) self->vertices->items + index * self->vertices->item_size;
+}
+
+
+// ----------------------------------------------------- vertex_cache_index ---
+GLuint *
+vertex_cache_index( vertex_buffer_t * self, size_t index )
+{
+    if( self->index_chunks )
+    {
+        return (GLuint *) chunk_vector_get( self->index_chunks, index );
+    }
+    return (GLuint *) self->indices->items + index;
+}
+
+
+// ---------------------------------------------------- vertex_cache_misses ---
+size_t
+vertex_cache_misses( const GLuint * indices, size_t icount, size_t vstart,
+                     size_t * stamps, size_t vcount, size_t cache_size )
+{
+    // A vertex is in the FIFO while less than cache_size vertices have been
+    // loaded after it
+    size_t i, time = cache_size + 1, misses = 0;
+
+    memset( stamps, 0, vcount * sizeof(size_t) );
+    for( i=0; i<icount; ++i )
+    {
+        size_t v = indices[i] - vstart;
+        if( (time - stamps[v]) > cache_size )
+        {
+            stamps[v] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+
+// -------------------------------------------------- vertex_cache_max_item ---
+void
+vertex_cache_max_item( vertex_buffer_t * self, size_t first, size_t count,
+                       size_t * vcount, size_t * icount )
+{
+    size_t i;
+
+    *vcount = *icount = 0;
+    for( i=first; i<first+count; ++i )
+    {
+        ivec4 item = ivec4_vector_get( self->items, i );
+        if( item.icount <= 0 )
+        {
+            continue;
+        }
+        if( (size_t) item.vcount > *vcount )
+        {
+            *vcount = item.vcount;
+        }
+        if( (size_t) item.icount > *icount )
+        {
+            *icount = item.icount;
+        }
+    }
+}
+
+
+// ----------------------------------------------------- vertex_buffer_acmr ---
+float
+vertex_buffer_acmr( vertex_buffer_t * self,
+                    size_t first, size_t count,
+                    size_t cache_size )
+{
+    size_t i, vcount, icount, misses = 0, triangles = 0;
+    size_t * stamps;
+
+    assert( self );
+    vertex_buffer_close_gap( self );
+    assert( self->primitive == GL_TRIANGLES );
+    assert( first + count <= vertex_buffer_size( self ) );
+    assert( cache_size > 0 );
+
+    vertex_cache_max_item( self, first, count, &vcount, &icount );
+    stamps = (size_t *) allocator_alloc( self->scratch,
+                                         vcount * sizeof(size_t) );
+    for( i=first; i<first+count; ++i )
+    {
+        ivec4 item = ivec4_vector_get( self->items, i );
+        if( item.icount <= 0 )
+        {
+            continue;
+        }
+        misses += vertex_cache_misses( vertex_cache_index( self, item.istart ),
+                                       item.icount, item.vstart,
+                                       stamps, item.vcount, cache_size );
+        triangles += item.icount / 3;
+    }
+    allocator_free( self->scratch, stamps, vcount * sizeof(size_t) );
+    return triangles ? misses / (float) triangles : 0;
+}
+
+
+// ----------------------------------------------------- vertex_cache_score ---
+float
+vertex_cache_score( const vertex_cache_t * cache, int position, int valence )
+{
+    float score = 0;
+
+    // Vertices without remaining triangles are never picked
+    if( valence == 0 )
+    {
+        return -1;
+    }
+    if( position >= 0 )
+    {
+        score = cache->position_score[position];
+    }
+    if( valence < VERTEX_CACHE_MAX_VALENCE )
+    {
+        return score + cache->valence_score[valence];
+    }
+    return score + 2.0f * powf( (float) valence, -0.5f );
+}
+
+
+// ------------------------------------------------------- vertex_cache_new ---
+vertex_cache_t *
+vertex_cache_new( const allocator_t * allocator, size_t vcount,
+                  size_t icount, size_t stride )
+{
+    vertex_cache_t * self =
+        (vertex_cache_t *) allocator_alloc( allocator,
+                                            sizeof(vertex_cache_t) );
+    size_t i, tcount = icount / 3;
+
+    self->allocator = allocator;
+    self->vcount = vcount;
+    self->tcount = tcount;
+    self->stride = stride;
+    self->offsets   = (int *) allocator_alloc( allocator,
+                                               (vcount+1) * sizeof(int) );
+    self->valence   = (int *) allocator_alloc( allocator,
+                                               vcount * sizeof(int) );
+    self->adjacency = (int *) allocator_alloc( allocator,
+                                               icount * sizeof(int) );
+    self->position  = (int *) allocator_alloc( allocator,
+                                               vcount * sizeof(int) );
+    self->score     = (float *) allocator_alloc( allocator,
+                                                 vcount * sizeof(float) );
+    self->tscore    = (float *) allocator_alloc( allocator,
+                                                 tcount * sizeof(float) );
+    self->added     = (char *) allocator_alloc( allocator, tcount );
+    self->indices   = (GLuint *) allocator_alloc( allocator,
+                                                  icount * sizeof(GLuint) );
+    self->remap     = (int *) allocator_alloc( allocator,
+                                               vcount * sizeof(int) );
+    self->vertices  = (char *) allocator_alloc( allocator, vcount * stride );
+
+    // Scores of Forsyth's algorithm: the last triangle vertices get a fixed
+    // score, others decay with their cache position; vertices with few
+    // remaining triangles are boosted
+    for( i=0; i<VERTEX_CACHE_SIZE; ++i )
+    {
+        if( i < 3 )
+        {
+            self->position_score[i] = 0.75f;
+        }
+        else
+        {
+            float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            self->position_score[i] = powf( 1.0f - (i - 3) * scale, 1.5f );
+        }
+    }
+    self->valence_score[0] = 0;
+    for( i=1; i<VERTEX_CACHE_MAX_VALENCE; ++i )
+    {
+        self->valence_score[i] = 2.0f * powf( (float) i, -0.5f );
+    }
+    return self;
+}
+
+
+// ---------------------------------------------------- vertex_cache_delete ---
+void
+vertex_cache_delete( vertex_cache_t * self )
+{
+    const allocator_t * allocator = self->allocator;
+    size_t vcount = self->vcount, tcount = self->tcount;
+
+    allocator_free( allocator, self->vertices, vcount * self->stride );
+    allocator_free( allocator, self->remap, vcount * sizeof(int) );
+    allocator_free( allocator, self->indices, 3 * tcount * sizeof(GLuint) );
+    allocator_free( allocator, self->added, tcount );
+    allocator_free( allocator, self->tscore, tcount * sizeof(float) );
+    allocator_free( allocator, self->score, vcount * sizeof(float) );
+    allocator_free( allocator, self->position, vcount * sizeof(int) );
+    allocator_free( allocator, self->adjacency, 3 * tcount * sizeof(int) );
+    allocator_free( allocator, self->valence, vcount * sizeof(int) );
+    allocator_free( allocator, self->offsets, (vcount+1) * sizeof(int) );
+    allocator_free( allocator, self, sizeof(vertex_cache_t) );
+}
+
+
+// ------------------------------------------------- vertex_cache_triangles ---
+void
+vertex_cache_triangles( vertex_cache_t * self, const GLuint * indices,
+                        size_t vcount, size_t tcount, size_t vstart )
+{
+    int * offsets = self->offsets, * valence = self->valence;
+    int * adjacency = self->adjacency, * position = self->position;
+    float * score = self->score, * tscore = self->tscore;
+    int cache[VERTEX_CACHE_SIZE + 3], update[VERTEX_CACHE_SIZE + 3];
+    size_t i, j, k, n_cache = 0, next = 0, emitted;
+    int best = -1;
+    float best_score = -1;
+
+    // Triangles of each vertex
+    memset( valence, 0, vcount * sizeof(int) );
+    for( i=0; i<3*tcount; ++i )
+    {
+        valence[indices[i] - vstart]++;
+    }
+    offsets[0] = 0;
+    for( i=0; i<vcount; ++i )
+    {
+        offsets[i+1] = offsets[i] + valence[i];
+        position[i] = offsets[i];
+    }
+    for( i=0; i<3*tcount; ++i )
+    {
+        adjacency[position[indices[i] - vstart]++] = i / 3;
+    }
+
+    for( i=0; i<vcount; ++i )
+    {
+        position[i] = -1;
+        score[i] = vertex_cache_score( self, -1, valence[i] );
+    }
+    for( i=0; i<tcount; ++i )
+    {
+        const GLuint * t = indices + 3*i;
+        tscore[i] = score[t[0] - vstart] + score[t[1] - vstart]
+                  + score[t[2] - vstart];
+        self->added[i] = 0;
+        if( tscore[i] > best_score )
+        {
+            best_score = tscore[i];
+            best = i;
+        }
+    }
+
+    for( emitted=0; emitted<tcount; ++emitted )
+    {
+        // No triangle left around the cache, take the next one in order
+        if( best < 0 )
+        {
+            while( self->added[next] )
+            {
+                next++;
+            }
+            best = next;
+        }
+
+        const GLuint * t = indices + 3*best;
+        int v[3] = { t[0] - vstart, t[1] - vstart, t[2] - vstart };
+        size_t n_update = 0;
+
+        self->added[best] = 1;
+        for( k=0; k<3; ++k )
+        {
+            self->indices[3*emitted + k] = v[k];
+
+            // Remove the triangle from the remaining ones of its vertices
+            int * list = adjacency + offsets[v[k]];
+            for( j=0; j<(size_t) valence[v[k]]; ++j )
+            {
+                if( list[j] == best )
+                {
+                    list[j] = list[--valence[v[k]]];
+                    break;
+                }
+            }
+            if( (k == 0) || ((v[k] != v[0]) && ((k == 1) || (v[k] != v[1]))) )
+            {
+                update[n_update++] = v[k];
+            }
+        }
+
+        // Triangle vertices move to the front of the cache, vertices beyond
+        // its size are evicted (but their score is still updated)
+        for( i=0; i<n_cache; ++i )
+        {
+            if( (cache[i] != v[0]) && (cache[i] != v[1]) &&
+                (cache[i] != v[2]) )
+            {
+                update[n_update++] = cache[i];
+            }
+        }
+        for( i=0; i<n_update; ++i )
+        {
+            position[update[i]] = (i < VERTEX_CACHE_SIZE) ? (int) i : -1;
+            score[update[i]] = vertex_cache_score( self, position[update[i]],
+                                                   valence[update[i]] );
+        }
+        n_cache = (n_update < VERTEX_CACHE_SIZE)
+                ? n_update : VERTEX_CACHE_SIZE;
+        memcpy( cache, update, n_cache * sizeof(int) );
+
+        // Best triangle among the ones of cached vertices
+        best = -1;
+        best_score = -1;
+        for( i=0; i<n_update; ++i )
+        {
+            int * list = adjacency + offsets[update[i]];
+            for( j=0; j<(size_t) valence[update[i]]; ++j )
+            {
+                const GLuint * u = indices + 3*list[j];
+                float s = score[u[0] - vstart] + score[u[1] - vstart]
+                        + score[u[2] - vstart];
+                tscore[list[j]] = s;
+                if( s > best_score )
+                {
+                    best_score = s;
+                    best = list[j];
+                }
+            }
+        }
+    }
+}
+
+
+// -------------------------------------------------- vertex_cache_vertices ---
+void
+vertex_cache_vertices( vertex_cache_t * self, GLuint * indices,
+                       char * vertices, size_t vcount, size_t icount,
+                       size_t vstart )
+{
+    size_t i, stride = self->stride;
+    int * remap = self->remap, next = 0;
+
+    // Vertices are numbered in order of first use, unused ones last
+    for( i=0; i<vcount; ++i )
+    {
+        remap[i] = -1;
+    }
+    for( i=0; i<icount; ++i )
+    {
+        if( remap[self->indices[i]] < 0 )
+        {
+            remap[self->indices[i]] = next++;
+        }
+    }
+    for( i=0; i<vcount; ++i )
+    {
+        if( remap[i] < 0 )
+        {
+            remap[i] = next++;
+        }
+        memcpy( self->vertices + remap[i] * stride,
+                vertices + i * stride, stride );
+    }
+    memcpy( vertices, self->vertices, vcount * stride );
+    for( i=0; i<icount; ++i )
+    {
+        indices[i] = remap[self->indices[i]] + vstart;
+    }
+}
+
+
+// ------------------------------------------------- vertex_buffer_optimize ---
+void
+vertex_buffer_optimize( vertex_buffer_t * self,
+                        size_t first, size_t count,
+                        float * acmr )
+{
+    size_t i, vcount, icount;
+    vertex_cache_t * cache;
+
+    assert( self );
+    assert( !self->uploading );
+    vertex_buffer_close_gap( self );
+    assert( self->primitive == GL_TRIANGLES );
+    assert( first + count <= vertex_buffer_size( self ) );
+
+    if( acmr )
+    {
+        acmr[0] = vertex_buffer_acmr( self, first, count,
+                                      VERTEX_CACHE_FIFO_SIZE );
+    }
+    vertex_buffer_unmap( self );
+    vertex_cache_max_item( self, first, count, &vcount, &icount );
+    cache = vertex_cache_new( self->scratch, vcount, icount,
+                              self->vertices->item_size );
+    for( i=first; i<first+count; ++i )
+    {
+        ivec4 item = ivec4_vector_get( self->items, i );
+        if( item.icount <= 0 )
+        {
+            continue;
+        }
+        assert( (item.icount % 3) == 0 );
+
+        GLuint * indices = vertex_cache_index( self, item.istart );
+        char * vertices = vertex_cache_vertex( self, item.vstart );
+        vertex_cache_triangles( cache, indices, item.vcount,
+                                item.icount / 3, item.vstart );
+        vertex_cache_vertices( cache, indices, vertices,
+                               item.vcount, item.icount, item.vstart );
+    }
+    vertex_cache_delete( cache );
+
+    // Static layers are optimized once, before their upload
+    self->dirty = 1;
+    if( acmr )
+    {
+        acmr[1] = vertex_buffer_acmr( self, first, count,
+                                      VERTEX_CACHE_FIFO_SIZE );
+    }
+}
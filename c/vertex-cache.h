@@ -0,0 +1,119 @@
+// ----------------------------------------------------------------------------
+// OpenGL Anti-Grain Geometry (GL-AGG) - Version 0.1
+// A high quality OpenGL rendering engine for C
+// Copyright (C) 2012 Nicolas P. Rougier. All rights reserved.
+// Contact: Nicolas.Rougier@gmail.com
+//          http://code.google.com/p/gl-agg/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// The views and conclusions contained in the software and documentation are
+// those of the authors and should not be interpreted as representing official
+// policies, either expressed or implied, of Nicolas P. Rougier.
+// ----------------------------------------------------------------------------
+#ifndef __VERTEX_CACHE_H__
+#define __VERTEX_CACHE_H__
+#include <stddef.h>
+
+#include "vertex-buffer.h"
+
+
+/**
+ * @file   vertex-cache.h
+ *
+ * @defgroup vertex-cache Vertex cache optimization
+ *
+ * Reordering of the triangles of vertex buffer items for the post-transform
+ * vertex cache, following Tom Forsyth's "Linear-speed vertex cache
+ * optimisation": triangles are emitted greedily by the score of their
+ * vertices in a simulated LRU cache, favouring recently used vertices and
+ * vertices having few remaining triangles. Vertices of each item are then
+ * renumbered in order of first use, such that vertex fetches are mostly
+ * sequential.
+ *
+ * Polygon fills (ear clipping, fans of joins) are emitted in an order that
+ * reloads many of their vertices; optimizing a static layer once
+ * tessellated brings the average cache miss ratio (ACMR, number of
+ * transformed vertices per triangle) close to its lower bound, the number
+ * of vertices per triangle (about 1.06 down to 0.73 for 0.67 on round
+ * polygons).
+ *
+ * Items keep their handles, vertex and index ranges, only the order within
+ * each item changes.
+ *
+ * Example Usage:
+ * @code
+ * float acmr[2];
+ * vertex_buffer_optimize( buffer, 0, vertex_buffer_size( buffer ), acmr );
+ * printf( "ACMR %.3f -> %.3f\n", acmr[0], acmr[1] );
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Size of the LRU cache simulated by the optimizer.
+ */
+#define VERTEX_CACHE_SIZE 32
+
+/**
+ * Size of the FIFO cache the ACMR is reported for by vertex_buffer_optimize.
+ */
+#define VERTEX_CACHE_FIFO_SIZE 16
+
+
+/**
+ * Average cache miss ratio of a range of items, i.e. number of vertices
+ * transformed per triangle with a FIFO post-transform cache.
+ *
+ * @param  self        a vertex buffer storing GL_TRIANGLES
+ * @param  first       handle of the first item
+ * @param  count       number of items
+ * @param  cache_size  number of vertices held by the cache
+ * @return             ACMR (0 if the items have no triangle)
+ */
+  float
+  vertex_buffer_acmr( vertex_buffer_t * self,
+                      size_t first, size_t count,
+                      size_t cache_size );
+
+
+/**
+ * Reorder the triangles then the vertices of each item of a range for
+ * vertex cache and fetch locality. Erased items are skipped. Temporary
+ * memory comes from the scratch allocator of the buffer.
+ *
+ * @param  self   a vertex buffer storing GL_TRIANGLES
+ * @param  first  handle of the first item
+ * @param  count  number of items
+ * @param  acmr   ACMR before and after (see VERTEX_CACHE_FIFO_SIZE), may
+ *                be 0
+ */
+  void
+  vertex_buffer_optimize( vertex_buffer_t * self,
+                          size_t first, size_t count,
+                          float * acmr );
+
+/** @} */
+
+#endif /* __VERTEX_CACHE_H__ */